@@ -0,0 +1,251 @@
+/* Shared-memory audio ring for sherpa.onnx
+ *
+ * A single-producer/single-consumer ring of float32 mono samples in a
+ * POSIX shared memory object. A capture process creates the ring and
+ * writes samples as they arrive; an R process follows it with
+ * OfflineRecognizer$follow_ring(). Neither side blocks or copies through
+ * the kernel: the producer writes into the mapping and publishes a new
+ * write position, the consumer reads and publishes a new read position.
+ *
+ * Header-only C (also valid C++). Needs POSIX shared memory and the
+ * GCC/Clang __atomic builtins; link with -lrt on glibc before 2.34.
+ * Find it with system.file("include", package = "sherpa.onnx").
+ *
+ * Layout (native byte order):
+ *     0  uint32  magic "SORB"
+ *     4  uint32  version (1)
+ *     8  uint32  sample_rate
+ *    12  uint32  channels (1)
+ *    16  uint64  capacity in samples (a power of two)
+ *    24  uint32  closed (set by the producer when it is done)
+ *    64  uint64  write_pos: samples ever written (producer only)
+ *   128  uint64  read_pos: samples ever read (consumer only)
+ *   256  float   samples[capacity]
+ * The positions sit on their own cache lines and only grow; sample i
+ * lives at samples[i % capacity].
+ *
+ * Producer:
+ *
+ *   sherpa_onnx_ring ring;
+ *   if (sherpa_onnx_ring_create(&ring, "/mic0", 16000 * 30, 16000) != 0)
+ *     perror("ring");
+ *   while (capturing) {
+ *     uint64_t n = sherpa_onnx_ring_write(&ring, block, block_len);
+ *     if (n < block_len) { ... consumer is behind: samples were dropped }
+ *   }
+ *   sherpa_onnx_ring_close_writer(&ring);
+ *   sherpa_onnx_ring_release(&ring);
+ */
+
+#ifndef SHERPA_ONNX_RING_H_
+#define SHERPA_ONNX_RING_H_
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SHERPA_ONNX_RING_MAGIC 0x42524f53u /* "SORB" */
+#define SHERPA_ONNX_RING_VERSION 1u
+#define SHERPA_ONNX_RING_HEADER_SIZE 256
+
+typedef struct sherpa_onnx_ring_header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t sample_rate;
+  uint32_t channels;
+  uint64_t capacity;
+  uint32_t closed;
+  uint32_t reserved;
+  uint8_t pad0[32];
+  uint64_t write_pos;
+  uint8_t pad1[56];
+  uint64_t read_pos;
+  uint8_t pad2[120];
+} sherpa_onnx_ring_header;
+
+typedef struct sherpa_onnx_ring {
+  int fd;
+  size_t size;
+  sherpa_onnx_ring_header *header;
+  float *samples;
+} sherpa_onnx_ring;
+
+/* Map an open shared memory object of `size` bytes */
+static inline int sherpa_onnx_ring_map_(sherpa_onnx_ring *ring, int fd, size_t size) {
+  void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    int saved = errno;
+    close(fd);
+    errno = saved;
+    return -1;
+  }
+  ring->fd = fd;
+  ring->size = size;
+  ring->header = (sherpa_onnx_ring_header *)base;
+  ring->samples = (float *)((char *)base + SHERPA_ONNX_RING_HEADER_SIZE);
+  return 0;
+}
+
+/* Create a ring named `name` (e.g. "/mic0"), replacing any ring of that
+ * name. `capacity` is rounded up to a power of two samples.
+ * Returns 0, or -1 with errno set. */
+static inline int sherpa_onnx_ring_create(sherpa_onnx_ring *ring, const char *name,
+                                          uint64_t capacity, uint32_t sample_rate) {
+  uint64_t cap = 1;
+  size_t size;
+  int fd;
+
+  if (capacity == 0 || capacity > ((uint64_t)1 << 40)) {
+    errno = EINVAL;
+    return -1;
+  }
+  while (cap < capacity) {
+    cap <<= 1;
+  }
+  size = SHERPA_ONNX_RING_HEADER_SIZE + (size_t)cap * sizeof(float);
+
+  shm_unlink(name);
+  fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return -1;
+  }
+  if (ftruncate(fd, (off_t)size) != 0) {
+    int saved = errno;
+    close(fd);
+    shm_unlink(name);
+    errno = saved;
+    return -1;
+  }
+  if (sherpa_onnx_ring_map_(ring, fd, size) != 0) {
+    shm_unlink(name);
+    return -1;
+  }
+
+  memset(ring->header, 0, SHERPA_ONNX_RING_HEADER_SIZE);
+  ring->header->version = SHERPA_ONNX_RING_VERSION;
+  ring->header->sample_rate = sample_rate;
+  ring->header->channels = 1;
+  ring->header->capacity = cap;
+  /* Publish the magic last so a consumer never sees a partial header */
+  __atomic_store_n(&ring->header->magic, SHERPA_ONNX_RING_MAGIC, __ATOMIC_RELEASE);
+  return 0;
+}
+
+/* Open an existing ring (consumer side). Returns 0, or -1 with errno set
+ * (EINVAL if the object is not a ring of this version). */
+static inline int sherpa_onnx_ring_open(sherpa_onnx_ring *ring, const char *name) {
+  struct stat st;
+  sherpa_onnx_ring_header *h;
+  int fd = shm_open(name, O_RDWR, 0);
+
+  if (fd < 0) {
+    return -1;
+  }
+  if (fstat(fd, &st) != 0 || st.st_size < SHERPA_ONNX_RING_HEADER_SIZE) {
+    close(fd);
+    errno = EINVAL;
+    return -1;
+  }
+  if (sherpa_onnx_ring_map_(ring, fd, (size_t)st.st_size) != 0) {
+    return -1;
+  }
+
+  h = ring->header;
+  if (__atomic_load_n(&h->magic, __ATOMIC_ACQUIRE) != SHERPA_ONNX_RING_MAGIC ||
+      h->version != SHERPA_ONNX_RING_VERSION || h->channels != 1 || h->capacity == 0 ||
+      (h->capacity & (h->capacity - 1)) != 0 ||
+      ring->size < SHERPA_ONNX_RING_HEADER_SIZE + h->capacity * sizeof(float)) {
+    munmap(ring->header, ring->size);
+    close(fd);
+    errno = EINVAL;
+    return -1;
+  }
+  return 0;
+}
+
+/* Write up to `n` samples without blocking; returns how many fit. The
+ * rest would overwrite samples the consumer has not read yet. */
+static inline uint64_t sherpa_onnx_ring_write(sherpa_onnx_ring *ring, const float *samples,
+                                              uint64_t n) {
+  sherpa_onnx_ring_header *h = ring->header;
+  const uint64_t write = h->write_pos;
+  const uint64_t read = __atomic_load_n(&h->read_pos, __ATOMIC_ACQUIRE);
+  const uint64_t free_space = h->capacity - (write - read);
+  const uint64_t mask = h->capacity - 1;
+  uint64_t first;
+
+  if (n > free_space) {
+    n = free_space;
+  }
+  first = h->capacity - (write & mask);
+  if (first > n) {
+    first = n;
+  }
+  memcpy(ring->samples + (write & mask), samples, (size_t)first * sizeof(float));
+  memcpy(ring->samples, samples + first, (size_t)(n - first) * sizeof(float));
+
+  __atomic_store_n(&h->write_pos, write + n, __ATOMIC_RELEASE);
+  return n;
+}
+
+/* Read up to `max` samples without blocking (consumer side); returns how
+ * many were read */
+static inline uint64_t sherpa_onnx_ring_read(sherpa_onnx_ring *ring, float *out,
+                                             uint64_t max) {
+  sherpa_onnx_ring_header *h = ring->header;
+  const uint64_t read = h->read_pos;
+  const uint64_t write = __atomic_load_n(&h->write_pos, __ATOMIC_ACQUIRE);
+  const uint64_t mask = h->capacity - 1;
+  uint64_t n = write - read;
+  uint64_t first;
+
+  if (n > max) {
+    n = max;
+  }
+  first = h->capacity - (read & mask);
+  if (first > n) {
+    first = n;
+  }
+  memcpy(out, ring->samples + (read & mask), (size_t)first * sizeof(float));
+  memcpy(out + first, ring->samples, (size_t)(n - first) * sizeof(float));
+
+  __atomic_store_n(&h->read_pos, read + n, __ATOMIC_RELEASE);
+  return n;
+}
+
+/* Samples written but not read yet */
+static inline uint64_t sherpa_onnx_ring_available(const sherpa_onnx_ring *ring) {
+  return __atomic_load_n(&ring->header->write_pos, __ATOMIC_ACQUIRE) -
+         __atomic_load_n(&ring->header->read_pos, __ATOMIC_ACQUIRE);
+}
+
+/* Mark the stream as finished (producer side) */
+static inline void sherpa_onnx_ring_close_writer(sherpa_onnx_ring *ring) {
+  __atomic_store_n(&ring->header->closed, 1u, __ATOMIC_RELEASE);
+}
+
+static inline int sherpa_onnx_ring_closed(const sherpa_onnx_ring *ring) {
+  return __atomic_load_n(&ring->header->closed, __ATOMIC_ACQUIRE) != 0;
+}
+
+/* Unmap the ring. The shared memory object stays until unlinked. */
+static inline void sherpa_onnx_ring_release(sherpa_onnx_ring *ring) {
+  if (ring->header != NULL) {
+    munmap(ring->header, ring->size);
+    close(ring->fd);
+    ring->header = NULL;
+    ring->samples = NULL;
+  }
+}
+
+/* Remove the shared memory object; mappings stay valid until released */
+static inline int sherpa_onnx_ring_unlink(const char *name) {
+  return shm_unlink(name);
+}
+
+#endif /* SHERPA_ONNX_RING_H_ */
@@ -0,0 +1,562 @@
+// Transcription of WAV members of tar and zip archives
+// Uses cpp11 for R interface
+//
+// Members are read one at a time into memory and parsed with parse_wav(),
+// so archives are never extracted to disk. Tar archives (ustar, pax and
+// GNU long names) are walked header by header; zip archives are listed
+// from their central directory and must store WAV members uncompressed.
+
+#include "recognizer.h"
+#include "vad.h"
+#include "wav.h"
+#include "pool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace cpp11;
+
+// Pax extended headers and GNU long names are read into memory; larger
+// ones than this are treated as corrupt
+static const uint64_t kMaxTarExtensionBytes = 1024 * 1024;
+
+// One archive member as seen by the reader
+struct ArchiveMember {
+  std::string name;
+  uint64_t size = 0;
+  // Empty if the member can be read; otherwise why it cannot
+  std::string unsupported;
+};
+
+static uint32_t le32(const char *p) {
+  const unsigned char *b = reinterpret_cast<const unsigned char *>(p);
+  return static_cast<uint32_t>(b[0]) | (static_cast<uint32_t>(b[1]) << 8) |
+         (static_cast<uint32_t>(b[2]) << 16) | (static_cast<uint32_t>(b[3]) << 24);
+}
+
+static uint16_t le16(const char *p) {
+  const unsigned char *b = reinterpret_cast<const unsigned char *>(p);
+  return static_cast<uint16_t>(b[0] | (b[1] << 8));
+}
+
+static uint32_t crc32(const char *data, size_t n) {
+  static const std::vector<uint32_t> table = [] {
+    std::vector<uint32_t> t(256);
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k) {
+        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      }
+      t[i] = c;
+    }
+    return t;
+  }();
+
+  uint32_t c = 0xFFFFFFFFu;
+  for (size_t i = 0; i < n; ++i) {
+    c = table[(c ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (c >> 8);
+  }
+  return c ^ 0xFFFFFFFFu;
+}
+
+// Iterates the members of an archive in order
+// next() moves to the following regular file; read() loads the data of
+// the current member (members that are not read are skipped with a seek).
+// Does not use the R API; errors throw std::runtime_error.
+class ArchiveReader {
+ public:
+  virtual ~ArchiveReader() {}
+  virtual bool next(ArchiveMember &member) = 0;
+  virtual void read(std::vector<char> &out) = 0;
+};
+
+class TarReader : public ArchiveReader {
+ public:
+  explicit TarReader(const std::string &path) : file_(path, std::ios::binary), path_(path) {
+    if (!file_.is_open()) {
+      throw std::runtime_error("Failed to open archive: " + path);
+    }
+  }
+
+  bool next(ArchiveMember &member) override {
+    std::string long_name;
+    uint64_t pax_size = 0;
+    bool have_pax_size = false;
+
+    for (;;) {
+      file_.clear();
+      file_.seekg(static_cast<std::streamoff>(next_header_));
+      char header[512];
+      if (!file_.read(header, 512)) {
+        return false;
+      }
+      // Two zero blocks end the archive; one is enough to stop
+      if (std::all_of(header, header + 512, [](char c) { return c == 0; })) {
+        return false;
+      }
+      check_header(header);
+
+      const uint64_t size = parse_number(header + 124, 12);
+      const char type = header[156];
+      data_offset_ = next_header_ + 512;
+      next_header_ = data_offset_ + (size + 511) / 512 * 512;
+
+      if (type == 'x' || type == 'L') {
+        // Extended header or GNU long name for the following member
+        if (size > kMaxTarExtensionBytes) {
+          throw std::runtime_error("Corrupt tar header: " + path_);
+        }
+        std::vector<char> data(static_cast<size_t>(size));
+        if (!file_.read(data.data(), data.size())) {
+          throw std::runtime_error("Truncated tar archive: " + path_);
+        }
+        if (type == 'L') {
+          long_name.assign(data.data(), strnlen(data.data(), data.size()));
+        } else {
+          parse_pax(data, long_name, pax_size, have_pax_size);
+        }
+        continue;
+      }
+
+      // Only regular files are members; directories, links and global
+      // pax headers are skipped
+      if (type != '0' && type != '\0' && type != '7') {
+        long_name.clear();
+        have_pax_size = false;
+        continue;
+      }
+
+      if (!long_name.empty()) {
+        member.name = long_name;
+      } else {
+        member.name.assign(header, strnlen(header, 100));
+        const std::string prefix(header + 345, strnlen(header + 345, 155));
+        if (memcmp(header + 257, "ustar", 5) == 0 && !prefix.empty()) {
+          member.name = prefix + "/" + member.name;
+        }
+      }
+      member.size = have_pax_size ? pax_size : size;
+      member.unsupported.clear();
+      if (have_pax_size) {
+        next_header_ = data_offset_ + (pax_size + 511) / 512 * 512;
+      }
+      member_size_ = member.size;
+      return true;
+    }
+  }
+
+  void read(std::vector<char> &out) override {
+    out.resize(static_cast<size_t>(member_size_));
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(data_offset_));
+    if (!file_.read(out.data(), out.size())) {
+      throw std::runtime_error("Truncated tar archive: " + path_);
+    }
+  }
+
+ private:
+  std::ifstream file_;
+  std::string path_;
+  uint64_t next_header_ = 0;
+  uint64_t data_offset_ = 0;
+  uint64_t member_size_ = 0;
+
+  void check_header(const char *header) const {
+    // The checksum is computed with its own field read as spaces
+    uint64_t sum = 0;
+    for (int i = 0; i < 512; ++i) {
+      sum += (i >= 148 && i < 156) ? ' ' : static_cast<unsigned char>(header[i]);
+    }
+    if (parse_number(header + 148, 8) != sum) {
+      throw std::runtime_error("Not a tar archive or corrupt header: " + path_);
+    }
+  }
+
+  // Octal, or base-256 when the high bit of the first byte is set
+  static uint64_t parse_number(const char *field, size_t n) {
+    uint64_t value = 0;
+    if (static_cast<unsigned char>(field[0]) & 0x80) {
+      value = static_cast<unsigned char>(field[0]) & 0x7F;
+      for (size_t i = 1; i < n; ++i) {
+        value = (value << 8) | static_cast<unsigned char>(field[i]);
+      }
+      return value;
+    }
+    for (size_t i = 0; i < n && field[i] != 0; ++i) {
+      if (field[i] >= '0' && field[i] <= '7') {
+        value = value * 8 + static_cast<uint64_t>(field[i] - '0');
+      }
+    }
+    return value;
+  }
+
+  // Records are "<length> <key>=<value>\n"; only path and size matter
+  static void parse_pax(const std::vector<char> &data, std::string &name, uint64_t &size,
+                        bool &have_size) {
+    size_t pos = 0;
+    while (pos < data.size()) {
+      size_t len = 0;
+      size_t i = pos;
+      while (i < data.size() && data[i] >= '0' && data[i] <= '9') {
+        len = len * 10 + static_cast<size_t>(data[i] - '0');
+        ++i;
+      }
+      if (len == 0 || pos + len > data.size() || i + 2 > pos + len || data[i] != ' ') {
+        break;
+      }
+      const std::string record(data.data() + i + 1, pos + len - i - 2);
+      const size_t eq = record.find('=');
+      if (eq != std::string::npos) {
+        const std::string key = record.substr(0, eq);
+        if (key == "path") {
+          name = record.substr(eq + 1);
+        } else if (key == "size") {
+          size = strtoull(record.c_str() + eq + 1, nullptr, 10);
+          have_size = true;
+        }
+      }
+      pos += len;
+    }
+  }
+};
+
+class ZipReader : public ArchiveReader {
+ public:
+  explicit ZipReader(const std::string &path) : file_(path, std::ios::binary), path_(path) {
+    if (!file_.is_open()) {
+      throw std::runtime_error("Failed to open archive: " + path);
+    }
+    read_directory();
+  }
+
+  bool next(ArchiveMember &member) override {
+    while (index_ < entries_.size()) {
+      const Entry &entry = entries_[index_++];
+      // Names ending in a slash are directories
+      if (!entry.name.empty() && entry.name.back() == '/') {
+        continue;
+      }
+      member.name = entry.name;
+      member.size = entry.size;
+      member.unsupported.clear();
+      if (entry.flags & 1) {
+        member.unsupported = "encrypted zip member";
+      } else if (entry.method != 0) {
+        member.unsupported = "compressed zip member (method " + std::to_string(entry.method) +
+                             "); store WAV files uncompressed, e.g. with zip -0";
+      }
+      return true;
+    }
+    return false;
+  }
+
+  void read(std::vector<char> &out) override {
+    const Entry &entry = entries_[index_ - 1];
+    if (entry.flags & 1 || entry.method != 0) {
+      throw std::runtime_error("Cannot read " + entry.name + " in " + path_);
+    }
+
+    char local[30];
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(entry.local_offset));
+    if (!file_.read(local, 30) || le32(local) != 0x04034b50u) {
+      throw std::runtime_error("Corrupt zip archive: " + path_);
+    }
+    const uint64_t data_offset = entry.local_offset + 30 + le16(local + 26) + le16(local + 28);
+
+    out.resize(static_cast<size_t>(entry.size));
+    file_.seekg(static_cast<std::streamoff>(data_offset));
+    if (!file_.read(out.data(), out.size())) {
+      throw std::runtime_error("Truncated zip archive: " + path_);
+    }
+    if (crc32(out.data(), out.size()) != entry.crc) {
+      throw std::runtime_error("CRC mismatch for " + entry.name + " in " + path_);
+    }
+  }
+
+ private:
+  struct Entry {
+    std::string name;
+    uint64_t size = 0;
+    uint64_t local_offset = 0;
+    uint32_t crc = 0;
+    int method = 0;
+    int flags = 0;
+  };
+
+  std::ifstream file_;
+  std::string path_;
+  std::vector<Entry> entries_;
+  size_t index_ = 0;
+
+  void read_directory() {
+    // The end of central directory record is in the last 64 KiB + 22 bytes
+    file_.seekg(0, std::ios::end);
+    const int64_t file_size = static_cast<int64_t>(file_.tellg());
+    const int64_t tail_size = std::min<int64_t>(file_size, 65535 + 22);
+    std::vector<char> tail(static_cast<size_t>(tail_size));
+    file_.seekg(file_size - tail_size);
+    if (!file_.read(tail.data(), tail.size())) {
+      throw std::runtime_error("Failed to read zip archive: " + path_);
+    }
+
+    int64_t eocd = -1;
+    for (int64_t i = tail_size - 22; i >= 0; --i) {
+      if (le32(tail.data() + i) == 0x06054b50u) {
+        eocd = i;
+        break;
+      }
+    }
+    if (eocd < 0) {
+      throw std::runtime_error("Not a zip archive: " + path_);
+    }
+
+    const char *end = tail.data() + eocd;
+    const uint16_t count = le16(end + 10);
+    const uint32_t dir_size = le32(end + 12);
+    const uint32_t dir_offset = le32(end + 16);
+    if (count == 0xFFFF || dir_size == 0xFFFFFFFFu || dir_offset == 0xFFFFFFFFu) {
+      throw std::runtime_error("ZIP64 archives are not supported: " + path_);
+    }
+
+    std::vector<char> dir(dir_size);
+    file_.seekg(dir_offset);
+    if (!file_.read(dir.data(), dir.size())) {
+      throw std::runtime_error("Corrupt zip archive: " + path_);
+    }
+
+    size_t pos = 0;
+    for (uint16_t i = 0; i < count; ++i) {
+      if (pos + 46 > dir.size() || le32(dir.data() + pos) != 0x02014b50u) {
+        throw std::runtime_error("Corrupt zip central directory: " + path_);
+      }
+      const char *h = dir.data() + pos;
+      const size_t name_len = le16(h + 28);
+      const size_t extra_len = le16(h + 30);
+      const size_t comment_len = le16(h + 32);
+      if (pos + 46 + name_len > dir.size()) {
+        throw std::runtime_error("Corrupt zip central directory: " + path_);
+      }
+
+      Entry entry;
+      entry.flags = le16(h + 8);
+      entry.method = le16(h + 10);
+      entry.crc = le32(h + 16);
+      entry.size = le32(h + 24);
+      entry.local_offset = le32(h + 42);
+      entry.name.assign(h + 46, name_len);
+      entries_.push_back(entry);
+
+      pos += 46 + name_len + extra_len + comment_len;
+    }
+  }
+};
+
+// Open a reader for a tar or zip archive, chosen by content
+static std::unique_ptr<ArchiveReader> open_archive(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open archive: " + path);
+  }
+  char magic[4] = {0, 0, 0, 0};
+  file.read(magic, 4);
+  file.close();
+
+  if (le32(magic) == 0x04034b50u || le32(magic) == 0x06054b50u) {
+    return std::unique_ptr<ArchiveReader>(new ZipReader(path));
+  }
+  return std::unique_ptr<ArchiveReader>(new TarReader(path));
+}
+
+// List the regular files of a tar or zip archive
+// Returns a list with name, size (bytes) and unsupported (NA if the member
+// can be read, otherwise the reason)
+[[cpp11::register]]
+list list_archive_(std::string archive_path) {
+  std::vector<ArchiveMember> members;
+  try {
+    std::unique_ptr<ArchiveReader> reader = open_archive(archive_path);
+    ArchiveMember member;
+    while (reader->next(member)) {
+      members.push_back(member);
+    }
+  } catch (const std::runtime_error &e) {
+    stop("%s", e.what());
+  }
+
+  writable::strings names(static_cast<R_xlen_t>(members.size()));
+  writable::doubles sizes(static_cast<R_xlen_t>(members.size()));
+  writable::strings unsupported(static_cast<R_xlen_t>(members.size()));
+  for (size_t i = 0; i < members.size(); ++i) {
+    names[i] = members[i].name;
+    sizes[i] = static_cast<double>(members[i].size);
+    unsupported[i] = members[i].unsupported.empty() ? r_string(NA_STRING)
+                                                    : r_string(members[i].unsupported);
+  }
+
+  writable::list out;
+  out.push_back({"name"_nm = names});
+  out.push_back({"size"_nm = sizes});
+  out.push_back({"unsupported"_nm = unsupported});
+  return out;
+}
+
+// Outcome of one archive member decoded on a worker thread
+struct MemberJob {
+  std::string name;
+  size_t index = 0;  // 1-based position among the archive's members
+  std::vector<char> bytes;
+  DecodedResult result;
+  int sample_rate = 0;
+  double duration = 0;
+  bool skipped = false;
+  std::string error;
+};
+
+// Decode the members named in `members` (in archive order) on a pool of
+// threads sharing one recognizer
+// The archive is read sequentially on the main thread; up to
+// 4 * num_workers members are held in memory at a time while the pool
+// parses and decodes them. Members longer than `max_duration` seconds (if
+// positive) are returned with `skipped = TRUE` and their `index` only, and
+// their audio is released; the caller routes them through VAD one at a
+// time with archive_member_vad_(). Failed members carry an `error`.
+[[cpp11::register]]
+list transcribe_archive_(SEXP recognizer_xptr, std::string archive_path, strings members,
+                         int num_workers, double max_duration, bool words) {
+  const SherpaOnnxOfflineRecognizer *recognizer =
+      get_recognizer_handle(recognizer_xptr)->recognizer;
+
+  std::unordered_set<std::string> wanted;
+  for (R_xlen_t i = 0; i < members.size(); ++i) {
+    wanted.insert(std::string(members[i]));
+  }
+
+  const size_t chunk = static_cast<size_t>(std::max(num_workers, 1)) * 4;
+  std::vector<MemberJob> done;
+  std::vector<MemberJob> jobs;
+
+  auto run_jobs = [&]() {
+    parallel_for(jobs.size(), num_workers, [&](size_t i) {
+      MemberJob &job = jobs[i];
+      try {
+        WavBuffer wav = parse_wav(job.bytes.data(), job.bytes.size(), job.name);
+        std::vector<char>().swap(job.bytes);
+
+        job.sample_rate = wav.sample_rate;
+        job.duration = wav.samples.size() / static_cast<double>(wav.sample_rate);
+        if (max_duration > 0 && job.duration > max_duration) {
+          job.skipped = true;
+          return;
+        }
+
+        job.result = decode_waveform_native(recognizer, wav.sample_rate, wav.samples.data(),
+                                            static_cast<int32_t>(wav.samples.size()));
+      } catch (const std::exception &e) {
+        job.error = e.what();
+      }
+    });
+    for (MemberJob &job : jobs) {
+      done.push_back(std::move(job));
+    }
+    jobs.clear();
+  };
+
+  try {
+    std::unique_ptr<ArchiveReader> reader = open_archive(archive_path);
+    ArchiveMember member;
+    size_t index = 0;
+    while (reader->next(member)) {
+      ++index;
+      if (wanted.find(member.name) == wanted.end()) {
+        continue;
+      }
+      MemberJob job;
+      job.name = member.name;
+      job.index = index;
+      if (!member.unsupported.empty()) {
+        job.error = member.name + ": " + member.unsupported;
+      } else {
+        reader->read(job.bytes);
+      }
+      jobs.push_back(std::move(job));
+      if (jobs.size() >= chunk) {
+        run_jobs();
+      }
+    }
+    run_jobs();
+  } catch (const std::runtime_error &e) {
+    stop("%s", e.what());
+  }
+
+  writable::list out(static_cast<R_xlen_t>(done.size()));
+  for (size_t i = 0; i < done.size(); ++i) {
+    const MemberJob &job = done[i];
+    writable::list item;
+    if (job.error.empty() && !job.skipped) {
+      item = decoded_result_to_list(job.result, words);
+    }
+    item.push_back({"member"_nm = job.name});
+    item.push_back({"duration"_nm = job.duration});
+    item.push_back({"skipped"_nm = job.skipped});
+    if (job.skipped) {
+      item.push_back({"index"_nm = static_cast<double>(job.index)});
+    }
+    if (job.error.empty()) {
+      item.push_back({"error"_nm = R_NilValue});
+    } else {
+      item.push_back({"error"_nm = job.error});
+    }
+    out[i] = item;
+  }
+
+  return out;
+}
+
+// Find speech in one archive member with a Silero VAD
+// `index` is the member's 1-based position as reported by
+// transcribe_archive_(), and `member` its name, checked in case the archive
+// changed in between. Only this member is read. Returns the result of
+// vad_segment_list() plus the member's sample_rate.
+[[cpp11::register]]
+list archive_member_vad_(std::string vad_model_path, std::string archive_path,
+                         std::string member, double index, double vad_threshold,
+                         double vad_min_silence, double vad_min_speech, double vad_max_speech,
+                         int vad_window_size) {
+  WavBuffer wav;
+  try {
+    std::unique_ptr<ArchiveReader> reader = open_archive(archive_path);
+    ArchiveMember entry;
+    bool found = false;
+    for (double i = 1; reader->next(entry); ++i) {
+      if (i == index) {
+        found = entry.name == member;
+        break;
+      }
+    }
+    if (!found) {
+      throw std::runtime_error("Member " + member + " not found in " + archive_path);
+    }
+    if (!entry.unsupported.empty()) {
+      throw std::runtime_error(entry.name + ": " + entry.unsupported);
+    }
+
+    std::vector<char> bytes;
+    reader->read(bytes);
+    wav = parse_wav(bytes.data(), bytes.size(), entry.name);
+  } catch (const std::runtime_error &e) {
+    stop("%s", e.what());
+  }
+
+  writable::list out(vad_segment_list(vad_model_path, wav.samples, wav.sample_rate,
+                                      vad_threshold, vad_min_silence, vad_min_speech,
+                                      vad_max_speech, vad_window_size, false));
+  out.push_back({"sample_rate"_nm = wav.sample_rate});
+  return out;
+}
@@ -0,0 +1,202 @@
+// Caption segmentation of word timings
+// Uses cpp11 for R interface
+
+#include "words.h"
+#include <cctype>
+#include <string>
+#include <vector>
+
+using namespace cpp11;
+
+// Limits for a single caption
+struct CaptionOptions {
+  int max_chars;
+  double max_duration;
+  double min_pause;
+};
+
+// Captions as parallel vectors
+struct Captions {
+  std::vector<double> starts;
+  std::vector<double> ends;
+  std::vector<std::string> texts;
+};
+
+// True if the word ends a sentence (. ? ! or their CJK forms)
+static bool ends_sentence(const std::string &word) {
+  if (word.empty()) {
+    return false;
+  }
+  const char last = word.back();
+  if (last == '.' || last == '?' || last == '!') {
+    return true;
+  }
+  // U+3002 IDEOGRAPHIC FULL STOP, U+FF01 and U+FF1F fullwidth ! and ?
+  static const char *const kCjkStops[] = {"\xe3\x80\x82", "\xef\xbc\x81", "\xef\xbc\x9f"};
+  for (const char *mark : kCjkStops) {
+    if (word.size() >= 3 && word.compare(word.size() - 3, 3, mark) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Cut words into captions. A new caption starts when adding the next word
+// would exceed max_chars or max_duration, when the pause before it is at
+// least min_pause, or after a word that ends a sentence.
+static Captions segment_captions(const WordSpans &words, const CaptionOptions &opts) {
+  Captions out;
+
+  std::string text;
+  size_t text_chars = 0;
+  double start = 0.0;
+  double end = 0.0;
+  bool open = false;
+  bool prev_cjk = false;
+  bool sentence_end = false;
+
+  auto flush = [&]() {
+    if (open) {
+      out.starts.push_back(start);
+      out.ends.push_back(end);
+      out.texts.push_back(text);
+    }
+    text.clear();
+    text_chars = 0;
+    open = false;
+  };
+
+  for (size_t i = 0; i < words.words.size(); ++i) {
+    const std::string &word = words.words[i];
+    if (word.empty()) {
+      continue;
+    }
+
+    const bool cjk = starts_with_cjk(word);
+    const bool needs_space = open && !(cjk && prev_cjk);
+    const size_t word_chars = utf8_length(word);
+    const double word_start = words.starts[i];
+    const double word_end = words.ends[i];
+
+    if (open) {
+      const bool too_long =
+          text_chars + (needs_space ? 1 : 0) + word_chars > static_cast<size_t>(opts.max_chars);
+      const bool too_slow = word_end - start > opts.max_duration;
+      const bool paused = word_start - end >= opts.min_pause;
+      if (too_long || too_slow || paused || sentence_end) {
+        flush();
+      }
+    }
+
+    if (!open) {
+      open = true;
+      start = word_start;
+    } else if (!(cjk && prev_cjk)) {
+      text += ' ';
+      ++text_chars;
+    }
+
+    text += word;
+    text_chars += word_chars;
+    end = word_end;
+    prev_cjk = cjk;
+    sentence_end = ends_sentence(word);
+  }
+
+  flush();
+
+  return out;
+}
+
+// Build captions from word timings
+// Returns a list with flat start, end and text vectors
+[[cpp11::register]]
+list build_captions_(strings words, doubles word_starts, doubles word_ends,
+                     int max_chars, double max_duration, double min_pause) {
+  if (word_starts.size() != words.size() || word_ends.size() != words.size()) {
+    stop("word_starts and word_ends must have one entry per word");
+  }
+  if (max_chars < 1) {
+    stop("max_chars must be at least 1");
+  }
+  if (max_duration <= 0) {
+    stop("max_duration must be positive");
+  }
+
+  WordSpans spans;
+  spans.words.reserve(words.size());
+  for (R_xlen_t i = 0; i < words.size(); ++i) {
+    spans.words.push_back(std::string(words[i]));
+  }
+  spans.starts.assign(word_starts.begin(), word_starts.end());
+  spans.ends.assign(word_ends.begin(), word_ends.end());
+
+  Captions captions = segment_captions(spans, {max_chars, max_duration, min_pause});
+
+  writable::strings texts(static_cast<R_xlen_t>(captions.texts.size()));
+  for (size_t i = 0; i < captions.texts.size(); ++i) {
+    texts[i] = captions.texts[i];
+  }
+
+  writable::list out;
+  out.push_back({"start"_nm = writable::doubles(captions.starts.begin(), captions.starts.end())});
+  out.push_back({"end"_nm = writable::doubles(captions.ends.begin(), captions.ends.end())});
+  out.push_back({"text"_nm = texts});
+
+  return out;
+}
+
+// Approximate word timings for segments without token timestamps
+// (e.g. Whisper results merged from VAD segments). Each segment's duration
+// is shared among its whitespace-separated words by character count.
+[[cpp11::register]]
+list segment_word_spans_(strings texts, doubles starts, doubles durations) {
+  if (starts.size() != texts.size() || durations.size() != texts.size()) {
+    stop("starts and durations must have one entry per segment");
+  }
+
+  WordSpans spans;
+
+  for (R_xlen_t s = 0; s < texts.size(); ++s) {
+    const std::string text(texts[s]);
+
+    std::vector<std::string> words;
+    size_t pos = 0;
+    while (pos < text.size()) {
+      while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+        ++pos;
+      }
+      size_t end = pos;
+      while (end < text.size() && !std::isspace(static_cast<unsigned char>(text[end]))) {
+        ++end;
+      }
+      if (end > pos) {
+        words.push_back(text.substr(pos, end - pos));
+      }
+      pos = end;
+    }
+
+    size_t total_chars = 0;
+    for (const std::string &w : words) {
+      total_chars += utf8_length(w);
+    }
+    if (total_chars == 0) {
+      continue;
+    }
+
+    const double seconds_per_char = durations[s] / static_cast<double>(total_chars);
+    double t = starts[s];
+    for (const std::string &w : words) {
+      const double d = seconds_per_char * static_cast<double>(utf8_length(w));
+      spans.words.push_back(w);
+      spans.starts.push_back(t);
+      spans.ends.push_back(t + d);
+      spans.durations.push_back(d);
+      t += d;
+    }
+  }
+
+  writable::list out;
+  append_words(out, spans);
+  return out;
+}
@@ -0,0 +1,276 @@
+// Silence compaction for short-file decoding
+// Uses cpp11 for R interface
+//
+// Long silences are cut out of the waveform before decoding, so encoders
+// whose cost scales with the number of frames only see speech. The kept
+// regions form a piecewise offset map used to move token timestamps back
+// to the original time line.
+
+#include "recognizer.h"
+#include "vad.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace cpp11;
+
+// Region of the original waveform kept in the compacted audio, in samples
+struct KeptRegion {
+  int64_t start;   // position in the original audio
+  int64_t offset;  // position in the compacted audio
+  int64_t n;
+};
+
+// Turn sorted, possibly overlapping [start, end) spans into kept regions
+static std::vector<KeptRegion> merge_spans(std::vector<std::pair<int64_t, int64_t>> spans,
+                                           int64_t total) {
+  std::vector<KeptRegion> regions;
+  int64_t offset = 0;
+  for (auto &span : spans) {
+    int64_t start = std::max<int64_t>(0, span.first);
+    int64_t end = std::min(total, span.second);
+    if (end <= start) {
+      continue;
+    }
+    if (!regions.empty() && start <= regions.back().start + regions.back().n) {
+      KeptRegion &last = regions.back();
+      const int64_t grown = std::max(end, last.start + last.n) - last.start;
+      offset += grown - last.n;
+      last.n = grown;
+      continue;
+    }
+    regions.push_back({start, offset, end - start});
+    offset += end - start;
+  }
+  return regions;
+}
+
+// Find speech by frame energy relative to the loudest frame
+// Frames quieter than `threshold_db` below the peak are silence; silent
+// runs of at least `min_silence` seconds are removed except for `padding`
+// seconds next to speech.
+static std::vector<KeptRegion> energy_regions(const float *samples, int64_t n,
+                                              int sample_rate, double threshold_db,
+                                              double min_silence, double padding) {
+  const int64_t frame = std::max<int64_t>(1, sample_rate / 50);  // 20 ms
+  const int64_t num_frames = (n + frame - 1) / frame;
+
+  std::vector<double> level(num_frames);
+  double peak = -1e9;
+  for (int64_t f = 0; f < num_frames; ++f) {
+    const int64_t begin = f * frame;
+    const int64_t end = std::min(n, begin + frame);
+    double energy = 0;
+    for (int64_t i = begin; i < end; ++i) {
+      energy += static_cast<double>(samples[i]) * samples[i];
+    }
+    level[f] = 10.0 * std::log10(energy / (end - begin) + 1e-12);
+    peak = std::max(peak, level[f]);
+  }
+
+  const double floor_db = peak + threshold_db;
+  const int64_t min_run = static_cast<int64_t>(std::ceil(min_silence * sample_rate));
+  const int64_t pad = static_cast<int64_t>(padding * sample_rate);
+
+  // Keep everything except the inner part of long silent runs
+  std::vector<std::pair<int64_t, int64_t>> spans;
+  int64_t kept_from = 0;
+  int64_t f = 0;
+  while (f < num_frames) {
+    if (level[f] >= floor_db) {
+      ++f;
+      continue;
+    }
+    int64_t g = f;
+    while (g < num_frames && level[g] < floor_db) {
+      ++g;
+    }
+    const int64_t run_start = f * frame;
+    const int64_t run_end = std::min(n, g * frame);
+    if (run_end - run_start >= min_run) {
+      const int64_t cut_start = run_start == 0 ? 0 : run_start + pad;
+      const int64_t cut_end = run_end == n ? n : run_end - pad;
+      if (cut_end > cut_start) {
+        spans.emplace_back(kept_from, cut_start);
+        kept_from = cut_end;
+      }
+    }
+    f = g;
+  }
+  spans.emplace_back(kept_from, n);
+
+  return merge_spans(spans, n);
+}
+
+// Find speech with Silero VAD, widening each segment by `padding` seconds
+// Compaction only drops silence, so there is no minimum speech duration:
+// short words ("yes", "no") are kept.
+static std::vector<KeptRegion> vad_regions(const std::string &vad_model_path,
+                                           const float *samples, int64_t n,
+                                           int sample_rate, double min_silence,
+                                           double padding) {
+  const int kWindow = 512;
+  SherpaOnnxVadModelConfig vad_config = make_vad_config(
+      vad_model_path, sample_rate, 0.5, min_silence, 0.0, 60.0, kWindow);
+
+  VadPtr vad(SherpaOnnxCreateVoiceActivityDetector(&vad_config, 60.0f));
+  if (!vad) {
+    stop("Failed to create VAD instance. Check model path: %s", vad_model_path.c_str());
+  }
+  inject_fault("vad");
+
+  std::vector<SegmentBounds> segments;
+  for (int64_t i = 0; i + kWindow < n; i += kWindow) {
+    SherpaOnnxVoiceActivityDetectorAcceptWaveform(vad.get(), samples + i, kWindow);
+    collect_segments(vad.get(), false, segments);
+  }
+  SherpaOnnxVoiceActivityDetectorFlush(vad.get());
+  collect_segments(vad.get(), false, segments);
+
+  const int64_t pad = static_cast<int64_t>(padding * sample_rate);
+  std::vector<std::pair<int64_t, int64_t>> spans;
+  for (const SegmentBounds &seg : segments) {
+    spans.emplace_back(seg.start - pad, static_cast<int64_t>(seg.start) + seg.n + pad);
+  }
+
+  return merge_spans(spans, n);
+}
+
+// Map a time in the compacted audio back to the original audio
+static double original_time(double t, const std::vector<KeptRegion> &regions,
+                            int sample_rate) {
+  const double pos = t * sample_rate;
+  auto it = std::upper_bound(regions.begin(), regions.end(), pos,
+                             [](double p, const KeptRegion &r) { return p < r.offset; });
+  const KeptRegion &region = it == regions.begin() ? regions.front() : *(it - 1);
+  return (region.start + (pos - region.offset)) / sample_rate;
+}
+
+// Build the offset map for sorted [start, end) sample spans and map times
+// in the compacted audio back to the original; used by tests of the map
+// without a model that reports timestamps
+[[cpp11::register]]
+list compaction_map_(doubles span_starts, doubles span_ends, double total,
+                     doubles times, int sample_rate) {
+  if (span_starts.size() != span_ends.size()) {
+    stop("span_starts and span_ends must have the same length");
+  }
+  std::vector<std::pair<int64_t, int64_t>> spans;
+  for (R_xlen_t i = 0; i < span_starts.size(); ++i) {
+    spans.emplace_back(static_cast<int64_t>(span_starts[i]),
+                       static_cast<int64_t>(span_ends[i]));
+  }
+  const std::vector<KeptRegion> regions = merge_spans(spans, static_cast<int64_t>(total));
+  if (regions.empty()) {
+    stop("No kept regions");
+  }
+
+  writable::doubles starts(static_cast<R_xlen_t>(regions.size()));
+  writable::doubles offsets(static_cast<R_xlen_t>(regions.size()));
+  writable::doubles lengths(static_cast<R_xlen_t>(regions.size()));
+  for (size_t i = 0; i < regions.size(); ++i) {
+    starts[i] = static_cast<double>(regions[i].start);
+    offsets[i] = static_cast<double>(regions[i].offset);
+    lengths[i] = static_cast<double>(regions[i].n);
+  }
+
+  writable::doubles mapped(times.size());
+  for (R_xlen_t i = 0; i < times.size(); ++i) {
+    mapped[i] = original_time(times[i], regions, sample_rate);
+  }
+
+  writable::list out;
+  out.push_back({"start"_nm = starts});
+  out.push_back({"offset"_nm = offsets});
+  out.push_back({"n"_nm = lengths});
+  out.push_back({"time"_nm = mapped});
+
+  return out;
+}
+
+// Transcribe a WAV file after removing long silences
+// `method` is "energy" or "vad" (`vad_model_path` is only used for "vad").
+// Token timestamps (and words) are reported in original time; the result
+// gains a `compaction` list with the durations and the offset map.
+[[cpp11::register]]
+list transcribe_compacted_(SEXP recognizer_xptr, std::string wav_path,
+                           std::string method, std::string vad_model_path,
+                           double threshold_db, double min_silence, double padding,
+                           bool words) {
+  const SherpaOnnxOfflineRecognizer *recognizer =
+      get_recognizer_handle(recognizer_xptr)->recognizer;
+
+  if (method != "energy" && method != "vad") {
+    stop("Unknown compaction method: %s", method.c_str());
+  }
+
+  WavePtr wave(SherpaOnnxReadWave(wav_path.c_str()));
+  if (!wave) {
+    stop("Failed to read WAV file: %s", wav_path.c_str());
+  }
+  inject_fault("wave");
+
+  const int sample_rate = wave->sample_rate;
+  const int64_t n = wave->num_samples;
+
+  std::vector<KeptRegion> regions;
+  if (method == "vad") {
+    if (sample_rate != 16000) {
+      stop("VAD compaction requires 16 kHz audio: %s", wav_path.c_str());
+    }
+    regions = vad_regions(vad_model_path, wave->samples, n, sample_rate,
+                          min_silence, padding);
+  } else {
+    regions = energy_regions(wave->samples, n, sample_rate, threshold_db,
+                             min_silence, padding);
+  }
+
+  // Nothing detected: decode the file as it is
+  if (regions.empty()) {
+    regions.push_back({0, 0, n});
+  }
+
+  std::vector<float> compacted;
+  compacted.reserve(regions.back().offset + regions.back().n);
+  for (const KeptRegion &region : regions) {
+    compacted.insert(compacted.end(), wave->samples + region.start,
+                     wave->samples + region.start + region.n);
+  }
+
+  DecodedResult result;
+  try {
+    result = decode_waveform_native(recognizer, sample_rate, compacted.data(),
+                                    static_cast<int32_t>(compacted.size()));
+  } catch (const std::runtime_error &e) {
+    stop("%s", e.what());
+  }
+
+  for (double &t : result.timestamps) {
+    t = original_time(t, regions, sample_rate);
+  }
+
+  writable::list out = decoded_result_to_list(result, words);
+
+  writable::doubles region_starts(static_cast<R_xlen_t>(regions.size()));
+  writable::doubles region_offsets(static_cast<R_xlen_t>(regions.size()));
+  writable::doubles region_durations(static_cast<R_xlen_t>(regions.size()));
+  for (size_t i = 0; i < regions.size(); ++i) {
+    region_starts[i] = regions[i].start / static_cast<double>(sample_rate);
+    region_offsets[i] = regions[i].offset / static_cast<double>(sample_rate);
+    region_durations[i] = regions[i].n / static_cast<double>(sample_rate);
+  }
+
+  writable::list compaction;
+  compaction.push_back({"method"_nm = method});
+  compaction.push_back({"original_duration"_nm = n / static_cast<double>(sample_rate)});
+  compaction.push_back({"decoded_duration"_nm =
+                            compacted.size() / static_cast<double>(sample_rate)});
+  compaction.push_back({"region_starts"_nm = region_starts});
+  compaction.push_back({"region_offsets"_nm = region_offsets});
+  compaction.push_back({"region_durations"_nm = region_durations});
+  out.push_back({"compaction"_nm = compaction});
+
+  return out;
+}
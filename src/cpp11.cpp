@@ -5,25 +5,151 @@
 #include "cpp11/declarations.hpp"
 #include <R_ext/Visibility.h>
 
+// archive.cpp
+list list_archive_(std::string archive_path);
+extern "C" SEXP _sherpa_onnx_list_archive_(SEXP archive_path) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(list_archive_(cpp11::as_cpp<cpp11::decay_t<std::string>>(archive_path)));
+  END_CPP11
+}
+// archive.cpp
+list transcribe_archive_(SEXP recognizer_xptr, std::string archive_path, strings members, int num_workers, double max_duration, bool words);
+extern "C" SEXP _sherpa_onnx_transcribe_archive_(SEXP recognizer_xptr, SEXP archive_path, SEXP members, SEXP num_workers, SEXP max_duration, SEXP words) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(transcribe_archive_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(recognizer_xptr), cpp11::as_cpp<cpp11::decay_t<std::string>>(archive_path), cpp11::as_cpp<cpp11::decay_t<strings>>(members), cpp11::as_cpp<cpp11::decay_t<int>>(num_workers), cpp11::as_cpp<cpp11::decay_t<double>>(max_duration), cpp11::as_cpp<cpp11::decay_t<bool>>(words)));
+  END_CPP11
+}
+// archive.cpp
+list archive_member_vad_(std::string vad_model_path, std::string archive_path, std::string member, double index, double vad_threshold, double vad_min_silence, double vad_min_speech, double vad_max_speech, int vad_window_size);
+extern "C" SEXP _sherpa_onnx_archive_member_vad_(SEXP vad_model_path, SEXP archive_path, SEXP member, SEXP index, SEXP vad_threshold, SEXP vad_min_silence, SEXP vad_min_speech, SEXP vad_max_speech, SEXP vad_window_size) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(archive_member_vad_(cpp11::as_cpp<cpp11::decay_t<std::string>>(vad_model_path), cpp11::as_cpp<cpp11::decay_t<std::string>>(archive_path), cpp11::as_cpp<cpp11::decay_t<std::string>>(member), cpp11::as_cpp<cpp11::decay_t<double>>(index), cpp11::as_cpp<cpp11::decay_t<double>>(vad_threshold), cpp11::as_cpp<cpp11::decay_t<double>>(vad_min_silence), cpp11::as_cpp<cpp11::decay_t<double>>(vad_min_speech), cpp11::as_cpp<cpp11::decay_t<double>>(vad_max_speech), cpp11::as_cpp<cpp11::decay_t<int>>(vad_window_size)));
+  END_CPP11
+}
+// captions.cpp
+list build_captions_(strings words, doubles word_starts, doubles word_ends, int max_chars, double max_duration, double min_pause);
+extern "C" SEXP _sherpa_onnx_build_captions_(SEXP words, SEXP word_starts, SEXP word_ends, SEXP max_chars, SEXP max_duration, SEXP min_pause) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(build_captions_(cpp11::as_cpp<cpp11::decay_t<strings>>(words), cpp11::as_cpp<cpp11::decay_t<doubles>>(word_starts), cpp11::as_cpp<cpp11::decay_t<doubles>>(word_ends), cpp11::as_cpp<cpp11::decay_t<int>>(max_chars), cpp11::as_cpp<cpp11::decay_t<double>>(max_duration), cpp11::as_cpp<cpp11::decay_t<double>>(min_pause)));
+  END_CPP11
+}
+// captions.cpp
+list segment_word_spans_(strings texts, doubles starts, doubles durations);
+extern "C" SEXP _sherpa_onnx_segment_word_spans_(SEXP texts, SEXP starts, SEXP durations) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(segment_word_spans_(cpp11::as_cpp<cpp11::decay_t<strings>>(texts), cpp11::as_cpp<cpp11::decay_t<doubles>>(starts), cpp11::as_cpp<cpp11::decay_t<doubles>>(durations)));
+  END_CPP11
+}
+// compact.cpp
+list compaction_map_(doubles span_starts, doubles span_ends, double total, doubles times, int sample_rate);
+extern "C" SEXP _sherpa_onnx_compaction_map_(SEXP span_starts, SEXP span_ends, SEXP total, SEXP times, SEXP sample_rate) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(compaction_map_(cpp11::as_cpp<cpp11::decay_t<doubles>>(span_starts), cpp11::as_cpp<cpp11::decay_t<doubles>>(span_ends), cpp11::as_cpp<cpp11::decay_t<double>>(total), cpp11::as_cpp<cpp11::decay_t<doubles>>(times), cpp11::as_cpp<cpp11::decay_t<int>>(sample_rate)));
+  END_CPP11
+}
+// compact.cpp
+list transcribe_compacted_(SEXP recognizer_xptr, std::string wav_path, std::string method, std::string vad_model_path, double threshold_db, double min_silence, double padding, bool words);
+extern "C" SEXP _sherpa_onnx_transcribe_compacted_(SEXP recognizer_xptr, SEXP wav_path, SEXP method, SEXP vad_model_path, SEXP threshold_db, SEXP min_silence, SEXP padding, SEXP words) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(transcribe_compacted_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(recognizer_xptr), cpp11::as_cpp<cpp11::decay_t<std::string>>(wav_path), cpp11::as_cpp<cpp11::decay_t<std::string>>(method), cpp11::as_cpp<cpp11::decay_t<std::string>>(vad_model_path), cpp11::as_cpp<cpp11::decay_t<double>>(threshold_db), cpp11::as_cpp<cpp11::decay_t<double>>(min_silence), cpp11::as_cpp<cpp11::decay_t<double>>(padding), cpp11::as_cpp<cpp11::decay_t<bool>>(words)));
+  END_CPP11
+}
+// handles.cpp
+list native_memory_();
+extern "C" SEXP _sherpa_onnx_native_memory_() {
+  BEGIN_CPP11
+    return cpp11::as_sexp(native_memory_());
+  END_CPP11
+}
+// handles.cpp
+std::string set_fault_injection_(std::string point);
+extern "C" SEXP _sherpa_onnx_set_fault_injection_(SEXP point) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(set_fault_injection_(cpp11::as_cpp<cpp11::decay_t<std::string>>(point)));
+  END_CPP11
+}
+// handles.cpp
+list process_memory_();
+extern "C" SEXP _sherpa_onnx_process_memory_() {
+  BEGIN_CPP11
+    return cpp11::as_sexp(process_memory_());
+  END_CPP11
+}
+// hash.cpp
+list segment_hashes_(list segment_samples, int margin, int edge_block);
+extern "C" SEXP _sherpa_onnx_segment_hashes_(SEXP segment_samples, SEXP margin, SEXP edge_block) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(segment_hashes_(cpp11::as_cpp<cpp11::decay_t<list>>(segment_samples), cpp11::as_cpp<cpp11::decay_t<int>>(margin), cpp11::as_cpp<cpp11::decay_t<int>>(edge_block)));
+  END_CPP11
+}
+// hash.cpp
+std::string string_hash_(std::string value);
+extern "C" SEXP _sherpa_onnx_string_hash_(SEXP value) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(string_hash_(cpp11::as_cpp<cpp11::decay_t<std::string>>(value)));
+  END_CPP11
+}
+// parallel.cpp
+list transcribe_files_(SEXP recognizer_xptr, strings wav_paths, int num_workers, double max_duration, bool words);
+extern "C" SEXP _sherpa_onnx_transcribe_files_(SEXP recognizer_xptr, SEXP wav_paths, SEXP num_workers, SEXP max_duration, SEXP words) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(transcribe_files_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(recognizer_xptr), cpp11::as_cpp<cpp11::decay_t<strings>>(wav_paths), cpp11::as_cpp<cpp11::decay_t<int>>(num_workers), cpp11::as_cpp<cpp11::decay_t<double>>(max_duration), cpp11::as_cpp<cpp11::decay_t<bool>>(words)));
+  END_CPP11
+}
+// parallel.cpp
+list transcribe_samples_parallel_(SEXP recognizer_xptr, list samples_list, int sample_rate, int num_workers, bool words);
+extern "C" SEXP _sherpa_onnx_transcribe_samples_parallel_(SEXP recognizer_xptr, SEXP samples_list, SEXP sample_rate, SEXP num_workers, SEXP words) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(transcribe_samples_parallel_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(recognizer_xptr), cpp11::as_cpp<cpp11::decay_t<list>>(samples_list), cpp11::as_cpp<cpp11::decay_t<int>>(sample_rate), cpp11::as_cpp<cpp11::decay_t<int>>(num_workers), cpp11::as_cpp<cpp11::decay_t<bool>>(words)));
+  END_CPP11
+}
+// parallel.cpp
+list transcribe_segment_batches_(SEXP recognizer_xptr, list segment_samples, list batch_segments, int sample_rate, int num_workers, bool words);
+extern "C" SEXP _sherpa_onnx_transcribe_segment_batches_(SEXP recognizer_xptr, SEXP segment_samples, SEXP batch_segments, SEXP sample_rate, SEXP num_workers, SEXP words) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(transcribe_segment_batches_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(recognizer_xptr), cpp11::as_cpp<cpp11::decay_t<list>>(segment_samples), cpp11::as_cpp<cpp11::decay_t<list>>(batch_segments), cpp11::as_cpp<cpp11::decay_t<int>>(sample_rate), cpp11::as_cpp<cpp11::decay_t<int>>(num_workers), cpp11::as_cpp<cpp11::decay_t<bool>>(words)));
+  END_CPP11
+}
+// parallel.cpp
+list transcribe_utterances_(SEXP recognizer_xptr, list segment_samples, int sample_rate, int batch_size, int num_workers, bool words);
+extern "C" SEXP _sherpa_onnx_transcribe_utterances_(SEXP recognizer_xptr, SEXP segment_samples, SEXP sample_rate, SEXP batch_size, SEXP num_workers, SEXP words) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(transcribe_utterances_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(recognizer_xptr), cpp11::as_cpp<cpp11::decay_t<list>>(segment_samples), cpp11::as_cpp<cpp11::decay_t<int>>(sample_rate), cpp11::as_cpp<cpp11::decay_t<int>>(batch_size), cpp11::as_cpp<cpp11::decay_t<int>>(num_workers), cpp11::as_cpp<cpp11::decay_t<bool>>(words)));
+  END_CPP11
+}
+// parallel.cpp
+list transcribe_fanout_(list recognizer_xptrs, strings wav_paths, integers segment_file, doubles segment_start, doubles segment_n, list batch_segments, int sample_rate, int num_workers, bool words);
+extern "C" SEXP _sherpa_onnx_transcribe_fanout_(SEXP recognizer_xptrs, SEXP wav_paths, SEXP segment_file, SEXP segment_start, SEXP segment_n, SEXP batch_segments, SEXP sample_rate, SEXP num_workers, SEXP words) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(transcribe_fanout_(cpp11::as_cpp<cpp11::decay_t<list>>(recognizer_xptrs), cpp11::as_cpp<cpp11::decay_t<strings>>(wav_paths), cpp11::as_cpp<cpp11::decay_t<integers>>(segment_file), cpp11::as_cpp<cpp11::decay_t<doubles>>(segment_start), cpp11::as_cpp<cpp11::decay_t<doubles>>(segment_n), cpp11::as_cpp<cpp11::decay_t<list>>(batch_segments), cpp11::as_cpp<cpp11::decay_t<int>>(sample_rate), cpp11::as_cpp<cpp11::decay_t<int>>(num_workers), cpp11::as_cpp<cpp11::decay_t<bool>>(words)));
+  END_CPP11
+}
+// recognizer.cpp
+SEXP create_offline_recognizer_(std::string model_dir, std::string model_type, std::string encoder_path, std::string decoder_path, std::string joiner_path, std::string model_path, std::string tokens_path, int num_threads, std::string provider, std::string language, std::string modeling_unit, std::string decoding_method, int max_active_paths, double blank_penalty, int tail_paddings, double model_bytes, double gc_threshold);
+extern "C" SEXP _sherpa_onnx_create_offline_recognizer_(SEXP model_dir, SEXP model_type, SEXP encoder_path, SEXP decoder_path, SEXP joiner_path, SEXP model_path, SEXP tokens_path, SEXP num_threads, SEXP provider, SEXP language, SEXP modeling_unit, SEXP decoding_method, SEXP max_active_paths, SEXP blank_penalty, SEXP tail_paddings, SEXP model_bytes, SEXP gc_threshold) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(create_offline_recognizer_(cpp11::as_cpp<cpp11::decay_t<std::string>>(model_dir), cpp11::as_cpp<cpp11::decay_t<std::string>>(model_type), cpp11::as_cpp<cpp11::decay_t<std::string>>(encoder_path), cpp11::as_cpp<cpp11::decay_t<std::string>>(decoder_path), cpp11::as_cpp<cpp11::decay_t<std::string>>(joiner_path), cpp11::as_cpp<cpp11::decay_t<std::string>>(model_path), cpp11::as_cpp<cpp11::decay_t<std::string>>(tokens_path), cpp11::as_cpp<cpp11::decay_t<int>>(num_threads), cpp11::as_cpp<cpp11::decay_t<std::string>>(provider), cpp11::as_cpp<cpp11::decay_t<std::string>>(language), cpp11::as_cpp<cpp11::decay_t<std::string>>(modeling_unit), cpp11::as_cpp<cpp11::decay_t<std::string>>(decoding_method), cpp11::as_cpp<cpp11::decay_t<int>>(max_active_paths), cpp11::as_cpp<cpp11::decay_t<double>>(blank_penalty), cpp11::as_cpp<cpp11::decay_t<int>>(tail_paddings), cpp11::as_cpp<cpp11::decay_t<double>>(model_bytes), cpp11::as_cpp<cpp11::decay_t<double>>(gc_threshold)));
+  END_CPP11
+}
 // recognizer.cpp
-SEXP create_offline_recognizer_(std::string model_dir, std::string model_type, std::string encoder_path, std::string decoder_path, std::string joiner_path, std::string model_path, std::string tokens_path, int num_threads, std::string provider, std::string language, std::string modeling_unit);
-extern "C" SEXP _sherpa_onnx_create_offline_recognizer_(SEXP model_dir, SEXP model_type, SEXP encoder_path, SEXP decoder_path, SEXP joiner_path, SEXP model_path, SEXP tokens_path, SEXP num_threads, SEXP provider, SEXP language, SEXP modeling_unit) {
+list transcribe_wav_(SEXP recognizer_xptr, std::string wav_path, bool words);
+extern "C" SEXP _sherpa_onnx_transcribe_wav_(SEXP recognizer_xptr, SEXP wav_path, SEXP words) {
   BEGIN_CPP11
-    return cpp11::as_sexp(create_offline_recognizer_(cpp11::as_cpp<cpp11::decay_t<std::string>>(model_dir), cpp11::as_cpp<cpp11::decay_t<std::string>>(model_type), cpp11::as_cpp<cpp11::decay_t<std::string>>(encoder_path), cpp11::as_cpp<cpp11::decay_t<std::string>>(decoder_path), cpp11::as_cpp<cpp11::decay_t<std::string>>(joiner_path), cpp11::as_cpp<cpp11::decay_t<std::string>>(model_path), cpp11::as_cpp<cpp11::decay_t<std::string>>(tokens_path), cpp11::as_cpp<cpp11::decay_t<int>>(num_threads), cpp11::as_cpp<cpp11::decay_t<std::string>>(provider), cpp11::as_cpp<cpp11::decay_t<std::string>>(language), cpp11::as_cpp<cpp11::decay_t<std::string>>(modeling_unit)));
+    return cpp11::as_sexp(transcribe_wav_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(recognizer_xptr), cpp11::as_cpp<cpp11::decay_t<std::string>>(wav_path), cpp11::as_cpp<cpp11::decay_t<bool>>(words)));
   END_CPP11
 }
 // recognizer.cpp
-list transcribe_wav_(SEXP recognizer_xptr, std::string wav_path);
-extern "C" SEXP _sherpa_onnx_transcribe_wav_(SEXP recognizer_xptr, SEXP wav_path) {
+list transcribe_samples_(SEXP recognizer_xptr, doubles samples, int sample_rate, bool words);
+extern "C" SEXP _sherpa_onnx_transcribe_samples_(SEXP recognizer_xptr, SEXP samples, SEXP sample_rate, SEXP words) {
   BEGIN_CPP11
-    return cpp11::as_sexp(transcribe_wav_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(recognizer_xptr), cpp11::as_cpp<cpp11::decay_t<std::string>>(wav_path)));
+    return cpp11::as_sexp(transcribe_samples_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(recognizer_xptr), cpp11::as_cpp<cpp11::decay_t<doubles>>(samples), cpp11::as_cpp<cpp11::decay_t<int>>(sample_rate), cpp11::as_cpp<cpp11::decay_t<bool>>(words)));
   END_CPP11
 }
 // recognizer.cpp
-list transcribe_samples_(SEXP recognizer_xptr, doubles samples, int sample_rate);
-extern "C" SEXP _sherpa_onnx_transcribe_samples_(SEXP recognizer_xptr, SEXP samples, SEXP sample_rate) {
+list transcribe_wav_raw_(SEXP recognizer_xptr, raws data, bool words);
+extern "C" SEXP _sherpa_onnx_transcribe_wav_raw_(SEXP recognizer_xptr, SEXP data, SEXP words) {
   BEGIN_CPP11
-    return cpp11::as_sexp(transcribe_samples_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(recognizer_xptr), cpp11::as_cpp<cpp11::decay_t<doubles>>(samples), cpp11::as_cpp<cpp11::decay_t<int>>(sample_rate)));
+    return cpp11::as_sexp(transcribe_wav_raw_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(recognizer_xptr), cpp11::as_cpp<cpp11::decay_t<raws>>(data), cpp11::as_cpp<cpp11::decay_t<bool>>(words)));
   END_CPP11
 }
 // recognizer.cpp
@@ -41,6 +167,150 @@ extern "C" SEXP _sherpa_onnx_read_wav_(SEXP wav_path) {
     return cpp11::as_sexp(read_wav_(cpp11::as_cpp<cpp11::decay_t<std::string>>(wav_path)));
   END_CPP11
 }
+// recognizer.cpp
+list read_wav_raw_(raws data);
+extern "C" SEXP _sherpa_onnx_read_wav_raw_(SEXP data) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(read_wav_raw_(cpp11::as_cpp<cpp11::decay_t<raws>>(data)));
+  END_CPP11
+}
+// recognizer.cpp
+list wav_info_(std::string wav_path);
+extern "C" SEXP _sherpa_onnx_wav_info_(SEXP wav_path) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(wav_info_(cpp11::as_cpp<cpp11::decay_t<std::string>>(wav_path)));
+  END_CPP11
+}
+// recognizer.cpp
+list read_wav_segments_(std::string wav_path, doubles starts, doubles durations, integers channels);
+extern "C" SEXP _sherpa_onnx_read_wav_segments_(SEXP wav_path, SEXP starts, SEXP durations, SEXP channels) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(read_wav_segments_(cpp11::as_cpp<cpp11::decay_t<std::string>>(wav_path), cpp11::as_cpp<cpp11::decay_t<doubles>>(starts), cpp11::as_cpp<cpp11::decay_t<doubles>>(durations), cpp11::as_cpp<cpp11::decay_t<integers>>(channels)));
+  END_CPP11
+}
+// ring.cpp
+SEXP ring_create_(std::string name, double capacity, int sample_rate);
+extern "C" SEXP _sherpa_onnx_ring_create_(SEXP name, SEXP capacity, SEXP sample_rate) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(ring_create_(cpp11::as_cpp<cpp11::decay_t<std::string>>(name), cpp11::as_cpp<cpp11::decay_t<double>>(capacity), cpp11::as_cpp<cpp11::decay_t<int>>(sample_rate)));
+  END_CPP11
+}
+// ring.cpp
+double ring_write_(SEXP ring_xptr, doubles samples);
+extern "C" SEXP _sherpa_onnx_ring_write_(SEXP ring_xptr, SEXP samples) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(ring_write_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(ring_xptr), cpp11::as_cpp<cpp11::decay_t<doubles>>(samples)));
+  END_CPP11
+}
+// ring.cpp
+void ring_close_(SEXP ring_xptr, std::string name, bool unlink);
+extern "C" SEXP _sherpa_onnx_ring_close_(SEXP ring_xptr, SEXP name, SEXP unlink) {
+  BEGIN_CPP11
+    ring_close_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(ring_xptr), cpp11::as_cpp<cpp11::decay_t<std::string>>(name), cpp11::as_cpp<cpp11::decay_t<bool>>(unlink));
+    return R_NilValue;
+  END_CPP11
+}
+// runtime.cpp
+list ort_providers_();
+extern "C" SEXP _sherpa_onnx_ort_providers_() {
+  BEGIN_CPP11
+    return cpp11::as_sexp(ort_providers_());
+  END_CPP11
+}
+// runtime.cpp
+list cpu_features_();
+extern "C" SEXP _sherpa_onnx_cpu_features_() {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpu_features_());
+  END_CPP11
+}
+// runtime.cpp
+list library_info_();
+extern "C" SEXP _sherpa_onnx_library_info_() {
+  BEGIN_CPP11
+    return cpp11::as_sexp(library_info_());
+  END_CPP11
+}
+// runtime.cpp
+list recognizer_info_(SEXP recognizer_xptr);
+extern "C" SEXP _sherpa_onnx_recognizer_info_(SEXP recognizer_xptr) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(recognizer_info_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(recognizer_xptr)));
+  END_CPP11
+}
+// stream.cpp
+SEXP create_offline_stream_(SEXP recognizer_xptr);
+extern "C" SEXP _sherpa_onnx_create_offline_stream_(SEXP recognizer_xptr) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(create_offline_stream_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(recognizer_xptr)));
+  END_CPP11
+}
+// stream.cpp
+void stream_accept_waveform_(SEXP stream_xptr, doubles samples, int sample_rate, double start, double end);
+extern "C" SEXP _sherpa_onnx_stream_accept_waveform_(SEXP stream_xptr, SEXP samples, SEXP sample_rate, SEXP start, SEXP end) {
+  BEGIN_CPP11
+    stream_accept_waveform_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(stream_xptr), cpp11::as_cpp<cpp11::decay_t<doubles>>(samples), cpp11::as_cpp<cpp11::decay_t<int>>(sample_rate), cpp11::as_cpp<cpp11::decay_t<double>>(start), cpp11::as_cpp<cpp11::decay_t<double>>(end));
+    return R_NilValue;
+  END_CPP11
+}
+// stream.cpp
+double stream_num_samples_(SEXP stream_xptr);
+extern "C" SEXP _sherpa_onnx_stream_num_samples_(SEXP stream_xptr) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(stream_num_samples_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(stream_xptr)));
+  END_CPP11
+}
+// stream.cpp
+list stream_decode_(SEXP stream_xptr, bool words);
+extern "C" SEXP _sherpa_onnx_stream_decode_(SEXP stream_xptr, SEXP words) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(stream_decode_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(stream_xptr), cpp11::as_cpp<cpp11::decay_t<bool>>(words)));
+  END_CPP11
+}
+// stream.cpp
+void destroy_stream_(SEXP stream_xptr);
+extern "C" SEXP _sherpa_onnx_destroy_stream_(SEXP stream_xptr) {
+  BEGIN_CPP11
+    destroy_stream_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(stream_xptr));
+    return R_NilValue;
+  END_CPP11
+}
+// tail.cpp
+SEXP create_wav_tail_(SEXP recognizer_xptr, std::string wav_path, std::string vad_model_path, double vad_threshold, double vad_min_silence, double vad_min_speech, double vad_max_speech, int vad_window_size);
+extern "C" SEXP _sherpa_onnx_create_wav_tail_(SEXP recognizer_xptr, SEXP wav_path, SEXP vad_model_path, SEXP vad_threshold, SEXP vad_min_silence, SEXP vad_min_speech, SEXP vad_max_speech, SEXP vad_window_size) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(create_wav_tail_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(recognizer_xptr), cpp11::as_cpp<cpp11::decay_t<std::string>>(wav_path), cpp11::as_cpp<cpp11::decay_t<std::string>>(vad_model_path), cpp11::as_cpp<cpp11::decay_t<double>>(vad_threshold), cpp11::as_cpp<cpp11::decay_t<double>>(vad_min_silence), cpp11::as_cpp<cpp11::decay_t<double>>(vad_min_speech), cpp11::as_cpp<cpp11::decay_t<double>>(vad_max_speech), cpp11::as_cpp<cpp11::decay_t<int>>(vad_window_size)));
+  END_CPP11
+}
+// tail.cpp
+SEXP create_fd_tail_(SEXP recognizer_xptr, std::string path, int fd, std::string format, int sample_rate, int channels, std::string vad_model_path, double vad_threshold, double vad_min_silence, double vad_min_speech, double vad_max_speech, int vad_window_size);
+extern "C" SEXP _sherpa_onnx_create_fd_tail_(SEXP recognizer_xptr, SEXP path, SEXP fd, SEXP format, SEXP sample_rate, SEXP channels, SEXP vad_model_path, SEXP vad_threshold, SEXP vad_min_silence, SEXP vad_min_speech, SEXP vad_max_speech, SEXP vad_window_size) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(create_fd_tail_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(recognizer_xptr), cpp11::as_cpp<cpp11::decay_t<std::string>>(path), cpp11::as_cpp<cpp11::decay_t<int>>(fd), cpp11::as_cpp<cpp11::decay_t<std::string>>(format), cpp11::as_cpp<cpp11::decay_t<int>>(sample_rate), cpp11::as_cpp<cpp11::decay_t<int>>(channels), cpp11::as_cpp<cpp11::decay_t<std::string>>(vad_model_path), cpp11::as_cpp<cpp11::decay_t<double>>(vad_threshold), cpp11::as_cpp<cpp11::decay_t<double>>(vad_min_silence), cpp11::as_cpp<cpp11::decay_t<double>>(vad_min_speech), cpp11::as_cpp<cpp11::decay_t<double>>(vad_max_speech), cpp11::as_cpp<cpp11::decay_t<int>>(vad_window_size)));
+  END_CPP11
+}
+// tail.cpp
+SEXP create_ring_tail_(SEXP recognizer_xptr, std::string name, std::string vad_model_path, double vad_threshold, double vad_min_silence, double vad_min_speech, double vad_max_speech, int vad_window_size);
+extern "C" SEXP _sherpa_onnx_create_ring_tail_(SEXP recognizer_xptr, SEXP name, SEXP vad_model_path, SEXP vad_threshold, SEXP vad_min_silence, SEXP vad_min_speech, SEXP vad_max_speech, SEXP vad_window_size) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(create_ring_tail_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(recognizer_xptr), cpp11::as_cpp<cpp11::decay_t<std::string>>(name), cpp11::as_cpp<cpp11::decay_t<std::string>>(vad_model_path), cpp11::as_cpp<cpp11::decay_t<double>>(vad_threshold), cpp11::as_cpp<cpp11::decay_t<double>>(vad_min_silence), cpp11::as_cpp<cpp11::decay_t<double>>(vad_min_speech), cpp11::as_cpp<cpp11::decay_t<double>>(vad_max_speech), cpp11::as_cpp<cpp11::decay_t<int>>(vad_window_size)));
+  END_CPP11
+}
+// tail.cpp
+list wav_tail_poll_(SEXP tail_xptr, bool flush, bool words, double max_frames);
+extern "C" SEXP _sherpa_onnx_wav_tail_poll_(SEXP tail_xptr, SEXP flush, SEXP words, SEXP max_frames) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(wav_tail_poll_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(tail_xptr), cpp11::as_cpp<cpp11::decay_t<bool>>(flush), cpp11::as_cpp<cpp11::decay_t<bool>>(words), cpp11::as_cpp<cpp11::decay_t<double>>(max_frames)));
+  END_CPP11
+}
+// tail.cpp
+void destroy_wav_tail_(SEXP tail_xptr);
+extern "C" SEXP _sherpa_onnx_destroy_wav_tail_(SEXP tail_xptr) {
+  BEGIN_CPP11
+    destroy_wav_tail_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(tail_xptr));
+    return R_NilValue;
+  END_CPP11
+}
 // vad.cpp
 list extract_vad_segments_(std::string vad_model_path, doubles samples, int sample_rate, double vad_threshold, double vad_min_silence, double vad_min_speech, double vad_max_speech, int vad_window_size, bool verbose);
 extern "C" SEXP _sherpa_onnx_extract_vad_segments_(SEXP vad_model_path, SEXP samples, SEXP sample_rate, SEXP vad_threshold, SEXP vad_min_silence, SEXP vad_min_speech, SEXP vad_max_speech, SEXP vad_window_size, SEXP verbose) {
@@ -48,15 +318,110 @@ extern "C" SEXP _sherpa_onnx_extract_vad_segments_(SEXP vad_model_path, SEXP sam
     return cpp11::as_sexp(extract_vad_segments_(cpp11::as_cpp<cpp11::decay_t<std::string>>(vad_model_path), cpp11::as_cpp<cpp11::decay_t<doubles>>(samples), cpp11::as_cpp<cpp11::decay_t<int>>(sample_rate), cpp11::as_cpp<cpp11::decay_t<double>>(vad_threshold), cpp11::as_cpp<cpp11::decay_t<double>>(vad_min_silence), cpp11::as_cpp<cpp11::decay_t<double>>(vad_min_speech), cpp11::as_cpp<cpp11::decay_t<double>>(vad_max_speech), cpp11::as_cpp<cpp11::decay_t<int>>(vad_window_size), cpp11::as_cpp<cpp11::decay_t<bool>>(verbose)));
   END_CPP11
 }
+// vad.cpp
+list vad_batch_(std::string vad_model_path, strings wav_paths, double vad_threshold, double vad_min_silence, double vad_min_speech, double vad_max_speech, int vad_window_size, int num_workers, bool keep_samples);
+extern "C" SEXP _sherpa_onnx_vad_batch_(SEXP vad_model_path, SEXP wav_paths, SEXP vad_threshold, SEXP vad_min_silence, SEXP vad_min_speech, SEXP vad_max_speech, SEXP vad_window_size, SEXP num_workers, SEXP keep_samples) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(vad_batch_(cpp11::as_cpp<cpp11::decay_t<std::string>>(vad_model_path), cpp11::as_cpp<cpp11::decay_t<strings>>(wav_paths), cpp11::as_cpp<cpp11::decay_t<double>>(vad_threshold), cpp11::as_cpp<cpp11::decay_t<double>>(vad_min_silence), cpp11::as_cpp<cpp11::decay_t<double>>(vad_min_speech), cpp11::as_cpp<cpp11::decay_t<double>>(vad_max_speech), cpp11::as_cpp<cpp11::decay_t<int>>(vad_window_size), cpp11::as_cpp<cpp11::decay_t<int>>(num_workers), cpp11::as_cpp<cpp11::decay_t<bool>>(keep_samples)));
+  END_CPP11
+}
+// vad.cpp
+list vad_summary_(std::string vad_model_path, strings wav_paths, double vad_threshold, double vad_min_silence, double vad_min_speech, double vad_max_speech, int vad_window_size, int num_workers, bool boundaries);
+extern "C" SEXP _sherpa_onnx_vad_summary_(SEXP vad_model_path, SEXP wav_paths, SEXP vad_threshold, SEXP vad_min_silence, SEXP vad_min_speech, SEXP vad_max_speech, SEXP vad_window_size, SEXP num_workers, SEXP boundaries) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(vad_summary_(cpp11::as_cpp<cpp11::decay_t<std::string>>(vad_model_path), cpp11::as_cpp<cpp11::decay_t<strings>>(wav_paths), cpp11::as_cpp<cpp11::decay_t<double>>(vad_threshold), cpp11::as_cpp<cpp11::decay_t<double>>(vad_min_silence), cpp11::as_cpp<cpp11::decay_t<double>>(vad_min_speech), cpp11::as_cpp<cpp11::decay_t<double>>(vad_max_speech), cpp11::as_cpp<cpp11::decay_t<int>>(vad_window_size), cpp11::as_cpp<cpp11::decay_t<int>>(num_workers), cpp11::as_cpp<cpp11::decay_t<bool>>(boundaries)));
+  END_CPP11
+}
+// vad_streams.cpp
+SEXP create_vad_streams_(std::string vad_model_path, int num_streams, double vad_threshold, double vad_min_silence, double vad_min_speech, double vad_max_speech, int vad_window_size, int num_workers);
+extern "C" SEXP _sherpa_onnx_create_vad_streams_(SEXP vad_model_path, SEXP num_streams, SEXP vad_threshold, SEXP vad_min_silence, SEXP vad_min_speech, SEXP vad_max_speech, SEXP vad_window_size, SEXP num_workers) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(create_vad_streams_(cpp11::as_cpp<cpp11::decay_t<std::string>>(vad_model_path), cpp11::as_cpp<cpp11::decay_t<int>>(num_streams), cpp11::as_cpp<cpp11::decay_t<double>>(vad_threshold), cpp11::as_cpp<cpp11::decay_t<double>>(vad_min_silence), cpp11::as_cpp<cpp11::decay_t<double>>(vad_min_speech), cpp11::as_cpp<cpp11::decay_t<double>>(vad_max_speech), cpp11::as_cpp<cpp11::decay_t<int>>(vad_window_size), cpp11::as_cpp<cpp11::decay_t<int>>(num_workers)));
+  END_CPP11
+}
+// vad_streams.cpp
+list vad_streams_accept_(SEXP xptr, list chunks, bool keep_samples);
+extern "C" SEXP _sherpa_onnx_vad_streams_accept_(SEXP xptr, SEXP chunks, SEXP keep_samples) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(vad_streams_accept_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(xptr), cpp11::as_cpp<cpp11::decay_t<list>>(chunks), cpp11::as_cpp<cpp11::decay_t<bool>>(keep_samples)));
+  END_CPP11
+}
+// vad_streams.cpp
+list vad_streams_flush_(SEXP xptr, bool keep_samples);
+extern "C" SEXP _sherpa_onnx_vad_streams_flush_(SEXP xptr, SEXP keep_samples) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(vad_streams_flush_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(xptr), cpp11::as_cpp<cpp11::decay_t<bool>>(keep_samples)));
+  END_CPP11
+}
+// vad_streams.cpp
+void destroy_vad_streams_(SEXP xptr);
+extern "C" SEXP _sherpa_onnx_destroy_vad_streams_(SEXP xptr) {
+  BEGIN_CPP11
+    destroy_vad_streams_(cpp11::as_cpp<cpp11::decay_t<SEXP>>(xptr));
+    return R_NilValue;
+  END_CPP11
+}
+// words.cpp
+list aggregate_words_(strings tokens, SEXP timestamps, SEXP durations);
+extern "C" SEXP _sherpa_onnx_aggregate_words_(SEXP tokens, SEXP timestamps, SEXP durations) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(aggregate_words_(cpp11::as_cpp<cpp11::decay_t<strings>>(tokens), cpp11::as_cpp<cpp11::decay_t<SEXP>>(timestamps), cpp11::as_cpp<cpp11::decay_t<SEXP>>(durations)));
+  END_CPP11
+}
 
 extern "C" {
 static const R_CallMethodDef CallEntries[] = {
-    {"_sherpa_onnx_create_offline_recognizer_", (DL_FUNC) &_sherpa_onnx_create_offline_recognizer_, 11},
-    {"_sherpa_onnx_destroy_recognizer_",        (DL_FUNC) &_sherpa_onnx_destroy_recognizer_,         1},
-    {"_sherpa_onnx_extract_vad_segments_",      (DL_FUNC) &_sherpa_onnx_extract_vad_segments_,       9},
-    {"_sherpa_onnx_read_wav_",                  (DL_FUNC) &_sherpa_onnx_read_wav_,                   1},
-    {"_sherpa_onnx_transcribe_samples_",        (DL_FUNC) &_sherpa_onnx_transcribe_samples_,         3},
-    {"_sherpa_onnx_transcribe_wav_",            (DL_FUNC) &_sherpa_onnx_transcribe_wav_,             2},
+    {"_sherpa_onnx_aggregate_words_",             (DL_FUNC) &_sherpa_onnx_aggregate_words_,              3},
+    {"_sherpa_onnx_archive_member_vad_",          (DL_FUNC) &_sherpa_onnx_archive_member_vad_,           9},
+    {"_sherpa_onnx_build_captions_",              (DL_FUNC) &_sherpa_onnx_build_captions_,               6},
+    {"_sherpa_onnx_compaction_map_",              (DL_FUNC) &_sherpa_onnx_compaction_map_,               5},
+    {"_sherpa_onnx_cpu_features_",                (DL_FUNC) &_sherpa_onnx_cpu_features_,                 0},
+    {"_sherpa_onnx_create_fd_tail_",              (DL_FUNC) &_sherpa_onnx_create_fd_tail_,              12},
+    {"_sherpa_onnx_create_offline_recognizer_",   (DL_FUNC) &_sherpa_onnx_create_offline_recognizer_,   17},
+    {"_sherpa_onnx_create_offline_stream_",       (DL_FUNC) &_sherpa_onnx_create_offline_stream_,        1},
+    {"_sherpa_onnx_create_ring_tail_",            (DL_FUNC) &_sherpa_onnx_create_ring_tail_,             8},
+    {"_sherpa_onnx_create_vad_streams_",          (DL_FUNC) &_sherpa_onnx_create_vad_streams_,           8},
+    {"_sherpa_onnx_create_wav_tail_",             (DL_FUNC) &_sherpa_onnx_create_wav_tail_,              8},
+    {"_sherpa_onnx_destroy_recognizer_",          (DL_FUNC) &_sherpa_onnx_destroy_recognizer_,           1},
+    {"_sherpa_onnx_destroy_stream_",              (DL_FUNC) &_sherpa_onnx_destroy_stream_,               1},
+    {"_sherpa_onnx_destroy_vad_streams_",         (DL_FUNC) &_sherpa_onnx_destroy_vad_streams_,          1},
+    {"_sherpa_onnx_destroy_wav_tail_",            (DL_FUNC) &_sherpa_onnx_destroy_wav_tail_,             1},
+    {"_sherpa_onnx_extract_vad_segments_",        (DL_FUNC) &_sherpa_onnx_extract_vad_segments_,         9},
+    {"_sherpa_onnx_library_info_",                (DL_FUNC) &_sherpa_onnx_library_info_,                 0},
+    {"_sherpa_onnx_list_archive_",                (DL_FUNC) &_sherpa_onnx_list_archive_,                 1},
+    {"_sherpa_onnx_native_memory_",               (DL_FUNC) &_sherpa_onnx_native_memory_,                0},
+    {"_sherpa_onnx_ort_providers_",               (DL_FUNC) &_sherpa_onnx_ort_providers_,                0},
+    {"_sherpa_onnx_process_memory_",              (DL_FUNC) &_sherpa_onnx_process_memory_,               0},
+    {"_sherpa_onnx_read_wav_",                    (DL_FUNC) &_sherpa_onnx_read_wav_,                     1},
+    {"_sherpa_onnx_read_wav_raw_",                (DL_FUNC) &_sherpa_onnx_read_wav_raw_,                 1},
+    {"_sherpa_onnx_read_wav_segments_",           (DL_FUNC) &_sherpa_onnx_read_wav_segments_,            4},
+    {"_sherpa_onnx_recognizer_info_",             (DL_FUNC) &_sherpa_onnx_recognizer_info_,              1},
+    {"_sherpa_onnx_ring_close_",                  (DL_FUNC) &_sherpa_onnx_ring_close_,                   3},
+    {"_sherpa_onnx_ring_create_",                 (DL_FUNC) &_sherpa_onnx_ring_create_,                  3},
+    {"_sherpa_onnx_ring_write_",                  (DL_FUNC) &_sherpa_onnx_ring_write_,                   2},
+    {"_sherpa_onnx_segment_hashes_",              (DL_FUNC) &_sherpa_onnx_segment_hashes_,               3},
+    {"_sherpa_onnx_segment_word_spans_",          (DL_FUNC) &_sherpa_onnx_segment_word_spans_,           3},
+    {"_sherpa_onnx_set_fault_injection_",         (DL_FUNC) &_sherpa_onnx_set_fault_injection_,          1},
+    {"_sherpa_onnx_stream_accept_waveform_",      (DL_FUNC) &_sherpa_onnx_stream_accept_waveform_,       5},
+    {"_sherpa_onnx_stream_decode_",               (DL_FUNC) &_sherpa_onnx_stream_decode_,                2},
+    {"_sherpa_onnx_stream_num_samples_",          (DL_FUNC) &_sherpa_onnx_stream_num_samples_,           1},
+    {"_sherpa_onnx_string_hash_",                 (DL_FUNC) &_sherpa_onnx_string_hash_,                  1},
+    {"_sherpa_onnx_transcribe_archive_",          (DL_FUNC) &_sherpa_onnx_transcribe_archive_,           6},
+    {"_sherpa_onnx_transcribe_compacted_",        (DL_FUNC) &_sherpa_onnx_transcribe_compacted_,         8},
+    {"_sherpa_onnx_transcribe_fanout_",           (DL_FUNC) &_sherpa_onnx_transcribe_fanout_,            9},
+    {"_sherpa_onnx_transcribe_files_",            (DL_FUNC) &_sherpa_onnx_transcribe_files_,             5},
+    {"_sherpa_onnx_transcribe_samples_",          (DL_FUNC) &_sherpa_onnx_transcribe_samples_,           4},
+    {"_sherpa_onnx_transcribe_samples_parallel_", (DL_FUNC) &_sherpa_onnx_transcribe_samples_parallel_,  5},
+    {"_sherpa_onnx_transcribe_segment_batches_",  (DL_FUNC) &_sherpa_onnx_transcribe_segment_batches_,   6},
+    {"_sherpa_onnx_transcribe_utterances_",       (DL_FUNC) &_sherpa_onnx_transcribe_utterances_,        6},
+    {"_sherpa_onnx_transcribe_wav_",              (DL_FUNC) &_sherpa_onnx_transcribe_wav_,               3},
+    {"_sherpa_onnx_transcribe_wav_raw_",          (DL_FUNC) &_sherpa_onnx_transcribe_wav_raw_,           3},
+    {"_sherpa_onnx_vad_batch_",                   (DL_FUNC) &_sherpa_onnx_vad_batch_,                    9},
+    {"_sherpa_onnx_vad_streams_accept_",          (DL_FUNC) &_sherpa_onnx_vad_streams_accept_,           3},
+    {"_sherpa_onnx_vad_streams_flush_",           (DL_FUNC) &_sherpa_onnx_vad_streams_flush_,            2},
+    {"_sherpa_onnx_vad_summary_",                 (DL_FUNC) &_sherpa_onnx_vad_summary_,                  9},
+    {"_sherpa_onnx_wav_info_",                    (DL_FUNC) &_sherpa_onnx_wav_info_,                     1},
+    {"_sherpa_onnx_wav_tail_poll_",               (DL_FUNC) &_sherpa_onnx_wav_tail_poll_,                4},
     {NULL, NULL, 0}
 };
 }
@@ -0,0 +1,180 @@
+// Incremental audio reader for pipes, FIFOs and file descriptors
+
+#include "fd.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const size_t kChunkBytes = 64 * 1024;
+// A header that has not ended after this many bytes is not a WAV header
+static const size_t kMaxHeaderBytes = 1024 * 1024;
+
+#ifdef _WIN32
+
+FdReader::FdReader(const std::string &, int, const std::string &, int, int) {
+  throw std::runtime_error("Reading from pipes and file descriptors is not supported on Windows");
+}
+
+FdReader::~FdReader() {}
+
+bool FdReader::fill() { return false; }
+
+#else
+
+FdReader::FdReader(const std::string &path, int fd, const std::string &format,
+                   int sample_rate, int channels) {
+  if (format == "wav") {
+    is_wav_ = true;
+  } else if (format == "s16le" || format == "f32le") {
+    if (sample_rate <= 0 || channels <= 0) {
+      throw std::runtime_error("Headerless PCM needs a positive sample rate and channel count");
+    }
+    format_.format = format == "s16le" ? 1 : 3;
+    format_.bits_per_sample = format == "s16le" ? 16 : 32;
+    format_.sample_rate = sample_rate;
+    format_.channels = channels;
+    ready_ = true;
+  } else {
+    throw std::runtime_error("Unknown stream format: " + format);
+  }
+
+  if (!path.empty()) {
+    // Non-blocking open does not wait for a FIFO's writer
+    fd_ = open(path.c_str(), O_RDONLY | O_NONBLOCK);
+    if (fd_ < 0) {
+      throw std::runtime_error("Failed to open " + path + ": " + strerror(errno));
+    }
+    owns_fd_ = true;
+    name_ = path;
+  } else {
+    fd_ = fd;
+    name_ = "file descriptor " + std::to_string(fd);
+    saved_flags_ = fcntl(fd_, F_GETFL);
+    if (saved_flags_ < 0) {
+      throw std::runtime_error("Invalid " + name_ + ": " + strerror(errno));
+    }
+    fcntl(fd_, F_SETFL, saved_flags_ | O_NONBLOCK);
+  }
+
+  struct stat st;
+  is_fifo_ = fstat(fd_, &st) == 0 && (S_ISFIFO(st.st_mode) || S_ISSOCK(st.st_mode));
+}
+
+FdReader::~FdReader() {
+  if (owns_fd_) {
+    close(fd_);
+  } else if (fd_ >= 0 && saved_flags_ >= 0) {
+    fcntl(fd_, F_SETFL, saved_flags_);
+  }
+}
+
+bool FdReader::fill() {
+  if (closed_) {
+    return false;
+  }
+
+  const size_t have = buffer_.size();
+  buffer_.resize(have + kChunkBytes);
+  ssize_t got;
+  do {
+    got = ::read(fd_, buffer_.data() + have, kChunkBytes);
+  } while (got < 0 && errno == EINTR);
+
+  if (got > 0) {
+    buffer_.resize(have + static_cast<size_t>(got));
+    got_data_ = true;
+    return true;
+  }
+  buffer_.resize(have);
+
+  if (got == 0) {
+    // A FIFO without a writer also reads as end of file; only treat it
+    // as the end once a writer has sent something
+    if (got_data_ || !is_fifo_) {
+      closed_ = true;
+    }
+    return false;
+  }
+  if (errno == EAGAIN || errno == EWOULDBLOCK) {
+    return false;
+  }
+  throw std::runtime_error("Failed to read from " + name_ + ": " + strerror(errno));
+}
+
+#endif  // _WIN32
+
+size_t FdReader::bytes_per_frame() const {
+  return static_cast<size_t>(format_.channels) * (format_.bits_per_sample / 8);
+}
+
+bool FdReader::read_header() {
+  while (!ready_) {
+    size_t offset = 0;
+    uint32_t data_size = 0;
+    if (parse_wav_header(buffer_.data(), buffer_.size(), name_, 0, format_, offset,
+                         data_size)) {
+      buffer_.erase(buffer_.begin(), buffer_.begin() + offset);
+      if (data_size != 0 && data_size != 0xFFFFFFFFu) {
+        remaining_ = data_size;
+      }
+      ready_ = true;
+      break;
+    }
+
+    if (buffer_.size() > kMaxHeaderBytes) {
+      throw std::runtime_error("No WAV data chunk in the first 1 MiB of " + name_);
+    }
+    if (!fill()) {
+      if (closed_) {
+        throw std::runtime_error("Stream ended before the WAV header: " + name_);
+      }
+      break;
+    }
+  }
+  return ready_;
+}
+
+bool FdReader::eof() const {
+  if (!ready_) {
+    return false;
+  }
+  const uint64_t usable = std::min<uint64_t>(buffer_.size(), remaining_);
+  return (closed_ || remaining_ == 0) && usable < bytes_per_frame();
+}
+
+size_t FdReader::read(float *out, size_t max_frames) {
+  if (!read_header()) {
+    return 0;
+  }
+
+  const size_t frame_bytes = bytes_per_frame();
+  size_t done = 0;
+  while (done < max_frames && remaining_ > 0) {
+    const size_t usable = static_cast<size_t>(std::min<uint64_t>(buffer_.size(), remaining_));
+    const size_t frames = std::min(usable / frame_bytes, max_frames - done);
+    if (frames == 0) {
+      if (!fill()) {
+        break;
+      }
+      continue;
+    }
+
+    decode_wav_frames(buffer_.data(), frames, format_, 0, out + done);
+    const size_t bytes = frames * frame_bytes;
+    buffer_.erase(buffer_.begin(), buffer_.begin() + bytes);
+    if (remaining_ != UINT64_MAX) {
+      remaining_ -= bytes;
+    }
+    done += frames;
+  }
+
+  position_ += static_cast<int64_t>(done);
+  return done;
+}
@@ -0,0 +1,71 @@
+// Incremental audio reader for pipes, FIFOs and file descriptors
+
+#ifndef SHERPA_ONNX_R_FD_H_
+#define SHERPA_ONNX_R_FD_H_
+
+#include "source.h"
+#include "wav.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Reads WAV or headerless PCM from a file descriptor as it arrives
+//
+// The descriptor is switched to non-blocking mode and read in chunks of
+// at most 64 KiB, so read() returns whatever is available now (possibly
+// nothing) and never waits for the writer. WAV streams may leave the data
+// size at 0 or 0xFFFFFFFF (ffmpeg and SoX do when writing to a pipe); the
+// stream then runs until the writer closes it. Samples are returned from
+// the first channel. POSIX only: on Windows the constructor throws. Does
+// not use the R API; errors throw std::runtime_error.
+class FdReader : public StreamSource {
+ public:
+  // Open `path` (e.g. a FIFO or /dev/stdin) if not empty, else read from
+  // `fd`, which is left open. `format` is "wav", "s16le" or "f32le";
+  // `sample_rate` and `channels` describe headerless PCM.
+  FdReader(const std::string &path, int fd, const std::string &format, int sample_rate,
+           int channels);
+  ~FdReader() override;
+
+  FdReader(const FdReader &) = delete;
+  FdReader &operator=(const FdReader &) = delete;
+
+  // Read until the WAV header is complete; returns whether it is
+  bool read_header() override;
+
+  // Only valid once read_header() returned true
+  int sample_rate() const override { return format_.sample_rate; }
+
+  // Frames returned so far
+  int64_t position() const override { return position_; }
+
+  // True once the writer has closed the stream (or the WAV data chunk
+  // has been read) and every frame has been returned
+  bool eof() const override;
+
+  // Read up to `max_frames` frames that are available without blocking
+  size_t read(float *out, size_t max_frames) override;
+
+ private:
+  int fd_ = -1;
+  bool owns_fd_ = false;
+  int saved_flags_ = -1;
+  bool is_fifo_ = false;
+  std::string name_;
+  bool is_wav_ = false;
+  bool ready_ = false;
+  bool closed_ = false;
+  bool got_data_ = false;
+  WavFormat format_;
+  // Bytes of the data chunk not yet buffered; UINT64_MAX if unknown
+  uint64_t remaining_ = UINT64_MAX;
+  int64_t position_ = 0;
+  std::vector<char> buffer_;
+
+  // One read() of at most a chunk; false if nothing new arrived
+  bool fill();
+  size_t bytes_per_frame() const;
+};
+
+#endif  // SHERPA_ONNX_R_FD_H_
@@ -0,0 +1,138 @@
+// Native memory accounting, fault injection and process memory statistics
+// Uses cpp11 for R interface
+
+#include "handles.h"
+#include <cpp11.hpp>
+#include <cstdio>
+#include <string>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#include <malloc/malloc.h>
+#endif
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+using namespace cpp11;
+
+// Native bytes held by live owners, and bytes registered since the last
+// collection triggered by native_memory_pressure() that are still live
+static double native_live_bytes = 0;
+static int native_live_handles = 0;
+static double native_pending_bytes = 0;
+static int native_collections = 0;
+
+int native_memory_register(double bytes) {
+  native_live_bytes += bytes;
+  native_pending_bytes += bytes;
+  ++native_live_handles;
+  return native_collections;
+}
+
+void native_memory_release(double bytes, int epoch) {
+  native_live_bytes -= bytes;
+  --native_live_handles;
+  // Bytes registered before the last collection were already cleared
+  // from the pending count
+  if (epoch == native_collections) {
+    native_pending_bytes -= bytes;
+    if (native_pending_bytes < 0) {
+      native_pending_bytes = 0;
+    }
+  }
+}
+
+void native_memory_pressure(double incoming_bytes, double threshold) {
+  if (threshold <= 0 || native_live_handles == 0) {
+    return;
+  }
+  if (native_pending_bytes + incoming_bytes > threshold) {
+    // Finalizers run inside R_gc() and release their bytes against the
+    // current epoch; the pending count restarts from zero afterwards
+    safe[R_gc]();
+    native_pending_bytes = 0;
+    ++native_collections;
+  }
+}
+
+// Report native memory accounting
+[[cpp11::register]]
+list native_memory_() {
+  writable::list out;
+  out.push_back({"live_bytes"_nm = native_live_bytes});
+  out.push_back({"live_handles"_nm = native_live_handles});
+  out.push_back({"pending_bytes"_nm = native_pending_bytes});
+  out.push_back({"collections"_nm = native_collections});
+
+  return out;
+}
+
+// Name of the point at which inject_fault() raises an error ("" = off)
+static std::string fault_point;
+
+void inject_fault(const char *point) {
+  if (!fault_point.empty() && fault_point == point) {
+    stop("Injected fault at '%s'", point);
+  }
+}
+
+// Enable fault injection at a named point, or disable it with ""
+// Returns the previous setting
+[[cpp11::register]]
+std::string set_fault_injection_(std::string point) {
+  std::string previous = fault_point;
+  fault_point = point;
+  return previous;
+}
+
+// Resident set size and allocated heap bytes of this process
+// Values are NA where the platform offers no cheap way to read them
+[[cpp11::register]]
+list process_memory_() {
+  double rss = NA_REAL;
+  double heap = NA_REAL;
+
+#if defined(__linux__)
+  // Second field of /proc/self/statm is resident pages
+  FILE *statm = fopen("/proc/self/statm", "r");
+  if (statm != nullptr) {
+    unsigned long size = 0, resident = 0;
+    if (fscanf(statm, "%lu %lu", &size, &resident) == 2) {
+      rss = static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE));
+    }
+    fclose(statm);
+  }
+#elif defined(__APPLE__)
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+    rss = static_cast<double>(info.resident_size);
+  }
+#endif
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  struct mallinfo2 mi = mallinfo2();
+  heap = static_cast<double>(mi.uordblks) + static_cast<double>(mi.hblkhd);
+#elif defined(__GLIBC__)
+  struct mallinfo mi = mallinfo();
+  heap = static_cast<double>(static_cast<unsigned int>(mi.uordblks)) +
+         static_cast<double>(static_cast<unsigned int>(mi.hblkhd));
+#elif defined(__APPLE__)
+  malloc_statistics_t stats;
+  malloc_zone_statistics(nullptr, &stats);
+  heap = static_cast<double>(stats.size_in_use);
+#endif
+
+  writable::list out;
+  out.push_back({"rss"_nm = rss});
+  out.push_back({"heap"_nm = heap});
+
+  return out;
+}
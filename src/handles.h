@@ -0,0 +1,58 @@
+// RAII owners for sherpa-onnx handles
+//
+// cpp11 turns R errors raised through its API (stop(), allocation of
+// writable vectors) into C++ exceptions, so handles held in these owners
+// are released on every error path. Raw R API calls that can longjmp must
+// go through cpp11::safe or cpp11::unwind_protect for the same reason.
+
+#ifndef SHERPA_ONNX_R_HANDLES_H_
+#define SHERPA_ONNX_R_HANDLES_H_
+
+#include <sherpa-onnx/c-api/c-api.h>
+#include <memory>
+
+// Deleter calling a sherpa-onnx destroy function
+template <typename T, void (*Destroy)(const T *)>
+struct SherpaDeleter {
+  void operator()(const T *p) const {
+    if (p != nullptr) {
+      Destroy(p);
+    }
+  }
+};
+
+template <typename T, void (*Destroy)(const T *)>
+using SherpaPtr = std::unique_ptr<const T, SherpaDeleter<T, Destroy>>;
+
+using WavePtr = SherpaPtr<SherpaOnnxWave, SherpaOnnxFreeWave>;
+using OfflineStreamPtr =
+    SherpaPtr<SherpaOnnxOfflineStream, SherpaOnnxDestroyOfflineStream>;
+using OfflineResultPtr =
+    SherpaPtr<SherpaOnnxOfflineRecognizerResult, SherpaOnnxDestroyOfflineRecognizerResult>;
+using VadPtr =
+    SherpaPtr<SherpaOnnxVoiceActivityDetector, SherpaOnnxDestroyVoiceActivityDetector>;
+using SpeechSegmentPtr =
+    SherpaPtr<SherpaOnnxSpeechSegment, SherpaOnnxDestroySpeechSegment>;
+
+// Accounting of native model memory
+//
+// R's garbage collector only sees the small external pointers, not the
+// model weights behind them, so it has no reason to run while dead
+// recognizers hold gigabytes. Owners report their estimated native size
+// here; once the bytes registered since the last collection and not yet
+// released exceed a threshold, native_memory_pressure() runs a full R GC
+// so finalizers of unreferenced owners free their models. The check only
+// runs where native_memory_pressure() is called (recognizer creation).
+//
+// native_memory_register() returns the collection epoch to pass back to
+// native_memory_release(), so an explicit close() only lowers the pending
+// count for owners registered since the last collection.
+int native_memory_register(double bytes);
+void native_memory_release(double bytes, int epoch);
+void native_memory_pressure(double incoming_bytes, double threshold);
+
+// Raise an R error if fault injection is enabled for `point`
+// Used by tests to exercise error paths while native handles are live
+void inject_fault(const char *point);
+
+#endif  // SHERPA_ONNX_R_HANDLES_H_
@@ -0,0 +1,164 @@
+// Content hashes for the per-segment transcript cache
+// Uses cpp11 for R interface
+
+#include <cpp11.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace cpp11;
+
+// 64-bit FNV-1a, continued from `h`
+static uint64_t fnv1a(const void *data, size_t n, uint64_t h = 0xcbf29ce484222325ULL) {
+  const unsigned char *p = static_cast<const unsigned char *>(data);
+  for (size_t i = 0; i < n; ++i) {
+    h ^= p[i];
+    h *= 0x100000001b3ULL;
+  }
+  return h;
+}
+
+static std::string to_hex(uint64_t h) {
+  char buf[17];
+  snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(h));
+  return buf;
+}
+
+// Random table for the gear rolling hash (splitmix64, fixed seed)
+static const std::vector<uint64_t> &gear_table() {
+  static const std::vector<uint64_t> table = [] {
+    std::vector<uint64_t> t(256);
+    uint64_t x = 0x9e3779b97f4a7c15ULL;
+    for (uint64_t &v : t) {
+      uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      v = z ^ (z >> 31);
+    }
+    return t;
+  }();
+  return table;
+}
+
+// Hash the audio of speech segments so that the same speech hashes the
+// same after edits elsewhere in the file
+//
+// VAD boundaries move by up to a window when audio before a segment is
+// trimmed or spliced, so hashing whole segments would miss. Hashes instead
+// cover the audio between content-defined anchors: positions where a gear
+// rolling hash of the 16-bit samples has its low 12 bits clear (about
+// every 4096 samples), ignoring `margin` samples at both ends. A moved
+// boundary can add or drop one anchor at each edge, so every segment gets
+// up to four keys, from the first or second anchor to the last or
+// second-to-last one; storing and looking up all four matches such pairs.
+//
+// A key alone says nothing about the audio outside its anchors, so each
+// key also gets edge fingerprints: hashes of consecutive blocks of
+// `edge_block` samples running outward from its first anchor to the
+// segment start (`heads`) and from its last anchor to the segment end
+// (`tails`). A cache hit is only valid if the stored and current edges
+// agree on every block both have and differ by at most a few blocks in
+// length, so trimmed or replaced audio at a segment edge misses while a
+// boundary moved by the VAD still hits.
+//
+// Returns list(keys, anchors, heads, tails): per segment, hex strings, the
+// offset of each key's first anchor from the segment start in samples,
+// and per key the head and tail block hashes. Segments with fewer than
+// two anchors are hashed whole with anchor 0 and no edge blocks.
+[[cpp11::register]]
+list segment_hashes_(list segment_samples, int margin, int edge_block) {
+  const std::vector<uint64_t> &gear = gear_table();
+  const uint64_t mask = (1ULL << 12) - 1;
+  if (edge_block < 1) {
+    stop("edge_block must be at least 1");
+  }
+  const size_t block = static_cast<size_t>(edge_block);
+
+  const R_xlen_t n = segment_samples.size();
+  writable::list keys(n);
+  writable::list anchors(n);
+  writable::list heads(n);
+  writable::list tails(n);
+
+  std::vector<int16_t> pcm;
+  std::vector<size_t> points;
+  for (R_xlen_t s = 0; s < n; ++s) {
+    doubles samples(segment_samples[s]);
+    const size_t len = samples.size();
+
+    pcm.resize(len);
+    for (size_t i = 0; i < len; ++i) {
+      double v = std::round(samples[i] * 32768.0);
+      v = v > 32767 ? 32767 : (v < -32768 ? -32768 : v);
+      pcm[i] = static_cast<int16_t>(v);
+    }
+
+    points.clear();
+    uint64_t rolling = 0;
+    for (size_t i = 0; i < len; ++i) {
+      const uint16_t bits = static_cast<uint16_t>(pcm[i]);
+      rolling = (rolling << 1) + gear[(bits >> 8) ^ (bits & 0xFF)];
+      if (i >= static_cast<size_t>(margin) && i + margin < len && (rolling & mask) == 0) {
+        points.push_back(i);
+      }
+    }
+
+    // (start, end) pairs of sample positions to hash
+    std::vector<std::pair<size_t, size_t>> regions;
+    const size_t k = points.size();
+    if (k < 2) {
+      regions.emplace_back(0, len);
+    } else {
+      const size_t starts[] = {points[0], points[1]};
+      const size_t ends[] = {points[k - 1], points[k - 2]};
+      for (size_t a : starts) {
+        for (size_t b : ends) {
+          if (b > a) {
+            regions.emplace_back(a, b);
+          }
+        }
+      }
+    }
+
+    writable::strings segment_keys(static_cast<R_xlen_t>(regions.size()));
+    writable::doubles segment_anchors(static_cast<R_xlen_t>(regions.size()));
+    writable::list segment_heads(static_cast<R_xlen_t>(regions.size()));
+    writable::list segment_tails(static_cast<R_xlen_t>(regions.size()));
+    for (size_t r = 0; r < regions.size(); ++r) {
+      const size_t from = regions[r].first;
+      const size_t to = regions[r].second;
+      segment_keys[r] = to_hex(fnv1a(pcm.data() + from, (to - from) * sizeof(int16_t)));
+      segment_anchors[r] = static_cast<double>(from);
+
+      writable::strings head;
+      for (size_t end = from; end >= block; end -= block) {
+        head.push_back(to_hex(fnv1a(pcm.data() + end - block, block * sizeof(int16_t))));
+      }
+      writable::strings tail;
+      for (size_t begin = to; begin + block <= len; begin += block) {
+        tail.push_back(to_hex(fnv1a(pcm.data() + begin, block * sizeof(int16_t))));
+      }
+      segment_heads[r] = head;
+      segment_tails[r] = tail;
+    }
+    keys[s] = segment_keys;
+    anchors[s] = segment_anchors;
+    heads[s] = segment_heads;
+    tails[s] = segment_tails;
+  }
+
+  writable::list out;
+  out.push_back({"keys"_nm = keys});
+  out.push_back({"anchors"_nm = anchors});
+  out.push_back({"heads"_nm = heads});
+  out.push_back({"tails"_nm = tails});
+  return out;
+}
+
+// Hash a string (used for cache keys of recognizer settings)
+[[cpp11::register]]
+std::string string_hash_(std::string value) {
+  return to_hex(fnv1a(value.data(), value.size()));
+}
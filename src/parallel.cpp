@@ -0,0 +1,440 @@
+// Parallel decoding on one shared recognizer
+// Uses cpp11 for R interface
+
+#include "recognizer.h"
+#include "wav.h"
+#include "pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace cpp11;
+
+// Outcome of one job decoded on a worker thread
+struct DecodeJob {
+  DecodedResult result;
+  std::string error;
+  double duration = 0;
+  bool skipped = false;
+};
+
+// Decode WAV files on a pool of threads sharing one recognizer
+// Each worker reads its file and decodes it with its own stream; only the
+// main thread touches R. Files longer than `max_duration` seconds (if
+// positive) are not decoded and come back with `skipped = TRUE` so the
+// caller can route them through VAD. Failed files carry an `error` string.
+[[cpp11::register]]
+list transcribe_files_(SEXP recognizer_xptr, strings wav_paths, int num_workers,
+                       double max_duration, bool words) {
+  const SherpaOnnxOfflineRecognizer *recognizer =
+      get_recognizer_handle(recognizer_xptr)->recognizer;
+
+  const size_t n = wav_paths.size();
+  std::vector<std::string> paths(n);
+  for (size_t i = 0; i < n; ++i) {
+    paths[i] = std::string(wav_paths[i]);
+  }
+
+  std::vector<DecodeJob> jobs(n);
+
+  parallel_for(n, num_workers, [&](size_t i) {
+    DecodeJob &job = jobs[i];
+    try {
+      if (!is_valid_wav(paths[i])) {
+        job.error = "Invalid WAV file: " + paths[i];
+        return;
+      }
+
+      WavePtr wave(SherpaOnnxReadWave(paths[i].c_str()));
+      if (!wave) {
+        job.error = "Failed to read WAV file: " + paths[i];
+        return;
+      }
+
+      job.duration = wave->num_samples / static_cast<double>(wave->sample_rate);
+      if (max_duration > 0 && job.duration > max_duration) {
+        job.skipped = true;
+        return;
+      }
+
+      job.result = decode_waveform_native(recognizer, wave->sample_rate,
+                                          wave->samples, wave->num_samples);
+    } catch (const std::exception &e) {
+      job.error = e.what();
+    }
+  });
+
+  writable::list out(static_cast<R_xlen_t>(n));
+  for (size_t i = 0; i < n; ++i) {
+    writable::list item;
+    if (jobs[i].error.empty() && !jobs[i].skipped) {
+      item = decoded_result_to_list(jobs[i].result, words);
+    }
+    item.push_back({"duration"_nm = jobs[i].duration});
+    item.push_back({"skipped"_nm = jobs[i].skipped});
+    if (jobs[i].error.empty()) {
+      item.push_back({"error"_nm = R_NilValue});
+    } else {
+      item.push_back({"error"_nm = jobs[i].error});
+    }
+    out[i] = item;
+  }
+
+  return out;
+}
+
+// Decode several sample vectors on a pool of threads sharing one recognizer
+// Returns one result list per element of `samples_list`, in input order
+[[cpp11::register]]
+list transcribe_samples_parallel_(SEXP recognizer_xptr, list samples_list,
+                                  int sample_rate, int num_workers, bool words) {
+  const SherpaOnnxOfflineRecognizer *recognizer =
+      get_recognizer_handle(recognizer_xptr)->recognizer;
+
+  // Convert on the main thread; workers only see float buffers
+  const size_t n = samples_list.size();
+  std::vector<std::vector<float>> buffers(n);
+  for (size_t i = 0; i < n; ++i) {
+    doubles samples(samples_list[i]);
+    if (samples.size() == 0) {
+      stop("Empty audio samples in element %d", static_cast<int>(i) + 1);
+    }
+    buffers[i].assign(samples.begin(), samples.end());
+  }
+
+  std::vector<DecodeJob> jobs(n);
+
+  parallel_for(n, num_workers, [&](size_t i) {
+    try {
+      jobs[i].result = decode_waveform_native(
+          recognizer, sample_rate, buffers[i].data(),
+          static_cast<int32_t>(buffers[i].size()));
+    } catch (const std::exception &e) {
+      jobs[i].error = e.what();
+    }
+  });
+
+  writable::list out(static_cast<R_xlen_t>(n));
+  for (size_t i = 0; i < n; ++i) {
+    if (!jobs[i].error.empty()) {
+      stop("Decoding element %d failed: %s", static_cast<int>(i) + 1,
+           jobs[i].error.c_str());
+    }
+    out[i] = decoded_result_to_list(jobs[i].result, words);
+  }
+
+  return out;
+}
+
+// Concatenate the segments of each batch into one float buffer
+// Runs on the main thread; workers only see the buffers
+static std::vector<std::vector<float>> concat_batches(list segment_samples,
+                                                      list batch_segments) {
+  const size_t n = batch_segments.size();
+  const R_xlen_t num_segments = segment_samples.size();
+  std::vector<std::vector<float>> buffers(n);
+
+  for (size_t b = 0; b < n; ++b) {
+    integers idx(batch_segments[b]);
+
+    size_t total = 0;
+    for (R_xlen_t k = 0; k < idx.size(); ++k) {
+      if (idx[k] < 1 || idx[k] > num_segments) {
+        stop("Segment index %d is out of range", idx[k]);
+      }
+      total += Rf_xlength(segment_samples[idx[k] - 1]);
+    }
+
+    buffers[b].reserve(total);
+    for (R_xlen_t k = 0; k < idx.size(); ++k) {
+      doubles samples(segment_samples[idx[k] - 1]);
+      buffers[b].insert(buffers[b].end(), samples.begin(), samples.end());
+    }
+
+    if (buffers[b].empty()) {
+      stop("Empty audio samples in batch %d", static_cast<int>(b) + 1);
+    }
+  }
+
+  return buffers;
+}
+
+// Decode VAD batches on a pool of threads sharing one recognizer
+// `segment_samples` holds the audio of every VAD segment and
+// `batch_segments` the 1-based segment indices of each batch. Each batch is
+// concatenated natively and decoded as one waveform. Returns one result
+// list per batch, in batch order.
+[[cpp11::register]]
+list transcribe_segment_batches_(SEXP recognizer_xptr, list segment_samples,
+                                 list batch_segments, int sample_rate,
+                                 int num_workers, bool words) {
+  const SherpaOnnxOfflineRecognizer *recognizer =
+      get_recognizer_handle(recognizer_xptr)->recognizer;
+
+  const size_t n = batch_segments.size();
+  std::vector<std::vector<float>> buffers = concat_batches(segment_samples, batch_segments);
+
+  std::vector<DecodeJob> jobs(n);
+
+  parallel_for(n, num_workers, [&](size_t b) {
+    try {
+      jobs[b].result = decode_waveform_native(
+          recognizer, sample_rate, buffers[b].data(),
+          static_cast<int32_t>(buffers[b].size()));
+    } catch (const std::exception &e) {
+      jobs[b].error = e.what();
+    }
+    // Release the batch audio as soon as it is decoded
+    std::vector<float>().swap(buffers[b]);
+  });
+
+  writable::list out(static_cast<R_xlen_t>(n));
+  for (size_t b = 0; b < n; ++b) {
+    if (!jobs[b].error.empty()) {
+      stop("Decoding batch %d failed: %s", static_cast<int>(b) + 1,
+           jobs[b].error.c_str());
+    }
+    out[b] = decoded_result_to_list(jobs[b].result, words);
+  }
+
+  return out;
+}
+
+// Decode speech segments as separate utterances
+// Segments are sorted by length (longest first) and cut into batches of
+// `batch_size`, so each multi-stream decode pads little; batches run on a
+// pool of workers sharing the recognizer. Results are in input order.
+[[cpp11::register]]
+list transcribe_utterances_(SEXP recognizer_xptr, list segment_samples,
+                            int sample_rate, int batch_size, int num_workers,
+                            bool words) {
+  const SherpaOnnxOfflineRecognizer *recognizer =
+      get_recognizer_handle(recognizer_xptr)->recognizer;
+
+  if (batch_size < 1) {
+    stop("batch_size must be at least 1");
+  }
+
+  // Copy on the main thread; workers only see float buffers
+  const size_t n = segment_samples.size();
+  std::vector<std::vector<float>> buffers(n);
+  for (size_t i = 0; i < n; ++i) {
+    doubles samples(segment_samples[i]);
+    if (samples.size() == 0) {
+      stop("Empty audio samples in segment %d", static_cast<int>(i) + 1);
+    }
+    buffers[i].assign(samples.begin(), samples.end());
+  }
+
+  std::vector<size_t> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return buffers[a].size() > buffers[b].size();
+  });
+
+  const size_t per_batch = static_cast<size_t>(batch_size);
+  const size_t num_batches = (n + per_batch - 1) / per_batch;
+  std::vector<DecodeJob> jobs(n);
+  std::vector<std::string> batch_errors(num_batches);
+
+  parallel_for(num_batches, num_workers, [&](size_t b) {
+    const size_t first = b * per_batch;
+    const size_t last = std::min(n, first + per_batch);
+
+    std::vector<const std::vector<float> *> waveforms;
+    for (size_t k = first; k < last; ++k) {
+      waveforms.push_back(&buffers[order[k]]);
+    }
+
+    try {
+      std::vector<DecodedResult> results =
+          decode_waveforms_native(recognizer, sample_rate, waveforms);
+      for (size_t k = first; k < last; ++k) {
+        jobs[order[k]].result = std::move(results[k - first]);
+      }
+    } catch (const std::exception &e) {
+      batch_errors[b] = e.what();
+    }
+
+    // Release the batch audio as soon as it is decoded
+    for (size_t k = first; k < last; ++k) {
+      std::vector<float>().swap(buffers[order[k]]);
+    }
+  });
+
+  for (size_t b = 0; b < num_batches; ++b) {
+    if (!batch_errors[b].empty()) {
+      stop("Decoding utterance batch %d failed: %s", static_cast<int>(b) + 1,
+           batch_errors[b].c_str());
+    }
+  }
+
+  writable::list out(static_cast<R_xlen_t>(n));
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = decoded_result_to_list(jobs[i].result, words);
+  }
+
+  return out;
+}
+
+// Audio of one fan-out batch: its file and the segments to concatenate
+// The samples are read by the first job that needs them and released by
+// the last one.
+struct FanoutBatch {
+  size_t file = 0;
+  std::vector<std::pair<int64_t, int64_t>> segments;  // (start, n) in frames
+  std::mutex mutex;
+  bool loaded = false;
+  std::vector<float> samples;
+  std::string error;
+  std::atomic<size_t> remaining{0};
+};
+
+// Read and concatenate the segments of a batch (no R API; throws
+// std::runtime_error)
+static std::vector<float> read_fanout_batch(const std::string &path, int sample_rate,
+                                            const FanoutBatch &batch) {
+  WavReader reader(path);
+  if (reader.sample_rate() != sample_rate) {
+    throw std::runtime_error("Expected " + std::to_string(sample_rate) +
+                             " Hz audio: " + path);
+  }
+
+  size_t total = 0;
+  for (const auto &seg : batch.segments) {
+    total += static_cast<size_t>(seg.second);
+  }
+  std::vector<float> samples(total);
+  size_t have = 0;
+  for (const auto &seg : batch.segments) {
+    reader.seek(seg.first);
+    const size_t want = have + static_cast<size_t>(seg.second);
+    while (have < want) {
+      const size_t got = reader.read(samples.data() + have, want - have);
+      if (got == 0) {
+        throw std::runtime_error("Segment extends past the end of " + path);
+      }
+      have += got;
+    }
+  }
+  if (samples.empty()) {
+    throw std::runtime_error("Empty audio samples in " + path);
+  }
+  return samples;
+}
+
+// Decode the same batches with several recognizers
+// Segments are given by file (1-based index into `wav_paths`), start and
+// length in frames; `batch_segments` holds the 1-based segment indices of
+// each batch. Each (recognizer, batch) pair is one job on the worker pool.
+// Jobs are handed out batch by batch, and a batch's audio is read natively
+// by its first job and shared read-only by the others, so only the batches
+// being decoded are held in memory. Returns one list of batch results per
+// recognizer, in input order.
+[[cpp11::register]]
+list transcribe_fanout_(list recognizer_xptrs, strings wav_paths, integers segment_file,
+                        doubles segment_start, doubles segment_n, list batch_segments,
+                        int sample_rate, int num_workers, bool words) {
+  const size_t m = recognizer_xptrs.size();
+  std::vector<const SherpaOnnxOfflineRecognizer *> recognizers(m);
+  for (size_t r = 0; r < m; ++r) {
+    recognizers[r] = get_recognizer_handle(recognizer_xptrs[r])->recognizer;
+  }
+
+  std::vector<std::string> paths(wav_paths.size());
+  for (R_xlen_t i = 0; i < wav_paths.size(); ++i) {
+    paths[i] = std::string(wav_paths[i]);
+  }
+
+  const R_xlen_t num_segments = segment_file.size();
+  if (segment_start.size() != num_segments || segment_n.size() != num_segments) {
+    stop("segment_file, segment_start and segment_n must have the same length");
+  }
+
+  const size_t n = batch_segments.size();
+  std::vector<FanoutBatch> batches(n);
+  for (size_t b = 0; b < n; ++b) {
+    integers idx(batch_segments[b]);
+    if (idx.size() == 0) {
+      stop("Empty audio samples in batch %d", static_cast<int>(b) + 1);
+    }
+    for (R_xlen_t k = 0; k < idx.size(); ++k) {
+      if (idx[k] < 1 || idx[k] > num_segments) {
+        stop("Segment index %d is out of range", idx[k]);
+      }
+      const R_xlen_t s = idx[k] - 1;
+      const int file = segment_file[s];
+      if (file < 1 || file > static_cast<int>(paths.size())) {
+        stop("File index %d is out of range", file);
+      }
+      if (k == 0) {
+        batches[b].file = static_cast<size_t>(file - 1);
+      } else if (batches[b].file != static_cast<size_t>(file - 1)) {
+        stop("Segments of batch %d come from different files", static_cast<int>(b) + 1);
+      }
+      if (!(segment_start[s] >= 0) || !(segment_n[s] >= 1)) {
+        stop("Invalid bounds of segment %d", idx[k]);
+      }
+      batches[b].segments.emplace_back(static_cast<int64_t>(segment_start[s]),
+                                       static_cast<int64_t>(segment_n[s]));
+    }
+    batches[b].remaining = m;
+  }
+
+  std::vector<DecodeJob> jobs(m * n);
+
+  parallel_for(m * n, num_workers, [&](size_t j) {
+    FanoutBatch &batch = batches[j / m];
+    {
+      std::lock_guard<std::mutex> lock(batch.mutex);
+      if (!batch.loaded) {
+        try {
+          batch.samples = read_fanout_batch(paths[batch.file], sample_rate, batch);
+        } catch (const std::exception &e) {
+          batch.error = e.what();
+        }
+        batch.loaded = true;
+      }
+    }
+
+    if (!batch.error.empty()) {
+      jobs[j].error = batch.error;
+    } else {
+      try {
+        jobs[j].result = decode_waveform_native(
+            recognizers[j % m], sample_rate, batch.samples.data(),
+            static_cast<int32_t>(batch.samples.size()));
+      } catch (const std::exception &e) {
+        jobs[j].error = e.what();
+      }
+    }
+
+    // Release the batch audio once every recognizer has decoded it
+    if (--batch.remaining == 0) {
+      std::vector<float>().swap(batch.samples);
+    }
+  });
+
+  writable::list out(static_cast<R_xlen_t>(m));
+  for (size_t r = 0; r < m; ++r) {
+    writable::list results(static_cast<R_xlen_t>(n));
+    for (size_t b = 0; b < n; ++b) {
+      const DecodeJob &job = jobs[b * m + r];
+      if (!job.error.empty()) {
+        stop("Decoding batch %d with recognizer %d failed: %s", static_cast<int>(b) + 1,
+             static_cast<int>(r) + 1, job.error.c_str());
+      }
+      results[b] = decoded_result_to_list(job.result, words);
+    }
+    out[r] = results;
+  }
+
+  return out;
+}
@@ -0,0 +1,54 @@
+// Minimal worker pool for native batch processing
+
+#ifndef SHERPA_ONNX_R_POOL_H_
+#define SHERPA_ONNX_R_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Run fn(worker, i) for every i in [0, n) on up to `num_workers` threads
+//
+// Items are handed out in order from a shared counter, so long items do not
+// hold up a statically assigned share. `worker` (0 .. num_workers - 1)
+// identifies the thread, for per-worker state such as model instances; the
+// calling thread is worker 0. `fn` must not throw and must not call the R
+// API.
+template <typename F>
+void parallel_for_workers(size_t n, int num_workers, F fn) {
+  const size_t workers = std::min(static_cast<size_t>(std::max(num_workers, 1)), n);
+
+  if (workers <= 1) {
+    for (size_t i = 0; i < n; ++i) {
+      fn(static_cast<size_t>(0), i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next(0);
+  auto work = [&](size_t worker) {
+    for (size_t i = next.fetch_add(1); i < n; i = next.fetch_add(1)) {
+      fn(worker, i);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(workers - 1);
+  for (size_t w = 1; w < workers; ++w) {
+    threads.emplace_back(work, w);
+  }
+  work(0);
+  for (std::thread &t : threads) {
+    t.join();
+  }
+}
+
+// Run fn(i) for every i in [0, n) on up to `num_workers` threads
+template <typename F>
+void parallel_for(size_t n, int num_workers, F fn) {
+  parallel_for_workers(n, num_workers, [&](size_t, size_t i) { fn(i); });
+}
+
+#endif  // SHERPA_ONNX_R_POOL_H_
@@ -1,63 +1,68 @@
 // C++ wrapper for sherpa-onnx offline recognizer
 // Uses cpp11 for R interface
 
-#include <sherpa-onnx/c-api/c-api.h>
-#include <cpp11.hpp>
+#include "recognizer.h"
+#include "wav.h"
+#include "words.h"
 #include <memory>
 #include <string>
 #include <vector>
 #include <cstring>
-#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
 
 using namespace cpp11;
 
-// Deleter function for the recognizer pointer
-static void delete_recognizer(const SherpaOnnxOfflineRecognizer *ptr) {
-  SherpaOnnxDestroyOfflineRecognizer(ptr);
-}
+// Copy a recognition result into plain C++ containers
+// Safe to call from worker threads (no R API)
+DecodedResult copy_result(const SherpaOnnxOfflineRecognizerResult *result) {
+  DecodedResult out;
 
-// Validate that a file is a valid WAV file
-// Returns true if valid, false otherwise
-static bool is_valid_wav(const std::string &filename) {
-  std::ifstream file(filename, std::ios::binary);
-  if (!file.is_open()) {
-    return false;
-  }
+  out.text = result->text != nullptr ? result->text : "";
 
-  // Read RIFF header (first 12 bytes)
-  char header[12];
-  file.read(header, 12);
-  if (!file) {
-    return false;
+  if (result->tokens_arr != nullptr && result->count > 0) {
+    out.tokens.assign(result->tokens_arr, result->tokens_arr + result->count);
+    if (result->timestamps != nullptr) {
+      out.has_timestamps = true;
+      out.timestamps.assign(result->timestamps, result->timestamps + result->count);
+    }
+    if (result->durations != nullptr) {
+      out.has_durations = true;
+      out.durations.assign(result->durations, result->durations + result->count);
+    }
   }
 
-  // Check for "RIFF" magic bytes (0x52494646)
-  if (header[0] != 'R' || header[1] != 'I' ||
-      header[2] != 'F' || header[3] != 'F') {
-    return false;
+  if (result->lang != nullptr) {
+    out.language = result->lang;
   }
-
-  // Check for "WAVE" format (0x57415645)
-  if (header[8] != 'W' || header[9] != 'A' ||
-      header[10] != 'V' || header[11] != 'E') {
-    return false;
+  if (result->emotion != nullptr) {
+    out.emotion = result->emotion;
+  }
+  if (result->event != nullptr) {
+    out.event = result->event;
+  }
+  if (result->json != nullptr) {
+    out.has_json = true;
+    out.json = result->json;
   }
 
-  return true;
+  return out;
 }
 
-// Helper function to convert recognition result to R list
-static writable::list convert_result_to_list(const SherpaOnnxOfflineRecognizerResult *result) {
+// Convert a decoded result to R list
+// With `words`, word-level fields are appended (see words.h)
+writable::list decoded_result_to_list(const DecodedResult &result, bool words) {
   writable::list out;
 
   // Text
-  out.push_back({"text"_nm = std::string(result->text)});
+  out.push_back({"text"_nm = result.text});
 
   // Tokens
-  if (result->tokens_arr != nullptr && result->count > 0) {
-    writable::strings tokens_vec;
-    for (int32_t i = 0; i < result->count; ++i) {
-      tokens_vec.push_back(std::string(result->tokens_arr[i]));
+  if (!result.tokens.empty()) {
+    writable::strings tokens_vec(static_cast<R_xlen_t>(result.tokens.size()));
+    for (size_t i = 0; i < result.tokens.size(); ++i) {
+      tokens_vec[i] = result.tokens[i];
     }
     out.push_back({"tokens"_nm = tokens_vec});
   } else {
@@ -65,58 +70,63 @@ static writable::list convert_result_to_list(const SherpaOnnxOfflineRecognizerRe
   }
 
   // Timestamps
-  if (result->timestamps != nullptr && result->count > 0) {
-    writable::doubles timestamps_vec;
-    for (int32_t i = 0; i < result->count; ++i) {
-      timestamps_vec.push_back(result->timestamps[i]);
-    }
-    out.push_back({"timestamps"_nm = timestamps_vec});
+  if (result.has_timestamps) {
+    out.push_back({"timestamps"_nm =
+                       writable::doubles(result.timestamps.begin(), result.timestamps.end())});
   } else {
     out.push_back({"timestamps"_nm = R_NilValue});
   }
 
   // Durations
-  if (result->durations != nullptr && result->count > 0) {
-    writable::doubles durations_vec;
-    for (int32_t i = 0; i < result->count; ++i) {
-      durations_vec.push_back(result->durations[i]);
-    }
-    out.push_back({"durations"_nm = durations_vec});
+  if (result.has_durations) {
+    out.push_back({"durations"_nm =
+                       writable::doubles(result.durations.begin(), result.durations.end())});
   } else {
     out.push_back({"durations"_nm = R_NilValue});
   }
 
   // Language
-  if (result->lang != nullptr && strlen(result->lang) > 0) {
-    out.push_back({"language"_nm = std::string(result->lang)});
+  if (!result.language.empty()) {
+    out.push_back({"language"_nm = result.language});
   } else {
     out.push_back({"language"_nm = R_NilValue});
   }
 
   // Emotion
-  if (result->emotion != nullptr && strlen(result->emotion) > 0) {
-    out.push_back({"emotion"_nm = std::string(result->emotion)});
+  if (!result.emotion.empty()) {
+    out.push_back({"emotion"_nm = result.emotion});
   } else {
     out.push_back({"emotion"_nm = R_NilValue});
   }
 
   // Event
-  if (result->event != nullptr && strlen(result->event) > 0) {
-    out.push_back({"event"_nm = std::string(result->event)});
+  if (!result.event.empty()) {
+    out.push_back({"event"_nm = result.event});
   } else {
     out.push_back({"event"_nm = R_NilValue});
   }
 
   // JSON
-  if (result->json != nullptr) {
-    out.push_back({"json"_nm = std::string(result->json)});
+  if (result.has_json) {
+    out.push_back({"json"_nm = result.json});
   } else {
     out.push_back({"json"_nm = R_NilValue});
   }
 
+  // Words
+  if (words) {
+    append_words(out, aggregate_words(result.tokens, result.timestamps, result.durations));
+  }
+
   return out;
 }
 
+// Helper function to convert recognition result to R list
+writable::list convert_result_to_list(const SherpaOnnxOfflineRecognizerResult *result,
+                                      bool words) {
+  return decoded_result_to_list(copy_result(result), words);
+}
+
 // Helper function to create a default config
 static SherpaOnnxOfflineRecognizerConfig get_default_config() {
   SherpaOnnxOfflineRecognizerConfig config;
@@ -147,7 +157,22 @@ SEXP create_offline_recognizer_(
     int num_threads,
     std::string provider,
     std::string language,
-    std::string modeling_unit) {
+    std::string modeling_unit,
+    std::string decoding_method,
+    int max_active_paths,
+    double blank_penalty,
+    int tail_paddings,
+    double model_bytes,
+    double gc_threshold) {
+
+  if (decoding_method != "greedy_search" &&
+      decoding_method != "modified_beam_search") {
+    stop("Unknown decoding method: %s", decoding_method.c_str());
+  }
+
+  if (max_active_paths < 1) {
+    stop("max_active_paths must be at least 1");
+  }
 
   // Create config
   SherpaOnnxOfflineRecognizerConfig config = get_default_config();
@@ -156,6 +181,11 @@ SEXP create_offline_recognizer_(
   config.model_config.provider = provider.c_str();
   config.model_config.tokens = tokens_path.c_str();
 
+  // Decoding settings (beam search only applies to transducer models)
+  config.decoding_method = decoding_method.c_str();
+  config.max_active_paths = max_active_paths;
+  config.blank_penalty = static_cast<float>(blank_penalty);
+
   // Set modeling_unit if provided (for transducer models)
   if (!modeling_unit.empty()) {
     config.model_config.modeling_unit = modeling_unit.c_str();
@@ -167,7 +197,7 @@ SEXP create_offline_recognizer_(
     config.model_config.whisper.decoder = decoder_path.c_str();
     config.model_config.whisper.language = language.c_str();
     config.model_config.whisper.task = "transcribe";
-    config.model_config.whisper.tail_paddings = -1;
+    config.model_config.whisper.tail_paddings = tail_paddings;
   } else if (model_type == "transducer") {
     config.model_config.transducer.encoder = encoder_path.c_str();
     config.model_config.transducer.decoder = decoder_path.c_str();
@@ -182,140 +212,210 @@ SEXP create_offline_recognizer_(
     stop("Unknown model type: %s", model_type.c_str());
   }
 
+  // Let R collect unreferenced recognizers before loading another model
+  native_memory_pressure(model_bytes, gc_threshold);
+
+  // The handle's destructor destroys the recognizer when the external
+  // pointer is finalized (or on any error below)
+  std::unique_ptr<RecognizerHandle> handle(new RecognizerHandle());
+
   // Create recognizer
-  const SherpaOnnxOfflineRecognizer *recognizer =
-      SherpaOnnxCreateOfflineRecognizer(&config);
+  handle->recognizer = SherpaOnnxCreateOfflineRecognizer(&config);
 
-  if (recognizer == nullptr) {
+  if (handle->recognizer == nullptr) {
     stop("Failed to create offline recognizer. Please check your model files.");
   }
+  handle->native_bytes = model_bytes;
+  handle->native_epoch = native_memory_register(model_bytes);
+  handle->model_type = model_type;
+  handle->provider = provider;
+  handle->num_threads = num_threads;
+  handle->decoding_method = decoding_method;
+  handle->max_active_paths = max_active_paths;
 
-  // Create external pointer with finalizer
-  external_pointer<const SherpaOnnxOfflineRecognizer> ptr(
-      recognizer,
-      true,
-      delete_recognizer);
+  external_pointer<RecognizerHandle> ptr(handle.release());
 
   return ptr;
 }
 
-// Transcribe a WAV file
-// Returns a list with transcription results
-[[cpp11::register]]
-list transcribe_wav_(SEXP recognizer_xptr, std::string wav_path) {
-  // Get recognizer from external pointer
-  external_pointer<const SherpaOnnxOfflineRecognizer> recognizer(recognizer_xptr);
-
-  if (recognizer.get() == nullptr) {
-    stop("Invalid recognizer pointer");
-  }
-
-  // Validate WAV file format before processing
-  if (!is_valid_wav(wav_path)) {
-    stop("Invalid WAV file: %s\nOnly standard WAV files (16-bit PCM, mono/stereo) are supported.\nFile must have RIFF/WAVE headers.", wav_path.c_str());
-  }
-
-  // Read WAV file
-  const SherpaOnnxWave *wave = SherpaOnnxReadWave(wav_path.c_str());
-  if (wave == nullptr) {
-    stop("Failed to read WAV file: %s", wav_path.c_str());
-  }
-
+// Decode one waveform with a recognizer
+// Every native handle is owned by an RAII wrapper, so R errors raised while
+// building the result do not leak the stream or the result
+writable::list decode_waveform(const SherpaOnnxOfflineRecognizer *recognizer,
+                               int sample_rate, const float *samples, int32_t n,
+                               bool words) {
   // Create stream
-  const SherpaOnnxOfflineStream *stream =
-      SherpaOnnxCreateOfflineStream(recognizer.get());
+  OfflineStreamPtr stream(SherpaOnnxCreateOfflineStream(recognizer));
 
-  if (stream == nullptr) {
-    SherpaOnnxFreeWave(wave);
+  if (!stream) {
     stop("Failed to create offline stream");
   }
+  inject_fault("stream");
 
   // Accept waveform
-  SherpaOnnxAcceptWaveformOffline(
-      stream,
-      wave->sample_rate,
-      wave->samples,
-      wave->num_samples);
+  SherpaOnnxAcceptWaveformOffline(stream.get(), sample_rate, samples, n);
 
   // Decode
-  SherpaOnnxDecodeOfflineStream(recognizer.get(), stream);
+  SherpaOnnxDecodeOfflineStream(recognizer, stream.get());
 
   // Get result
-  const SherpaOnnxOfflineRecognizerResult *result =
-      SherpaOnnxGetOfflineStreamResult(stream);
+  OfflineResultPtr result(SherpaOnnxGetOfflineStreamResult(stream.get()));
+
+  if (!result) {
+    stop("Failed to get recognition result");
+  }
+  inject_fault("result");
 
   // Convert result to R list using helper
-  writable::list out = convert_result_to_list(result);
+  return convert_result_to_list(result.get(), words);
+}
+
+// Decode one waveform without touching the R API
+// The recognizer may be shared: each call uses its own stream, and
+// sherpa-onnx offline recognizers support concurrent decoding of
+// different streams. Throws std::runtime_error on failure.
+DecodedResult decode_waveform_native(const SherpaOnnxOfflineRecognizer *recognizer,
+                                     int sample_rate, const float *samples, int32_t n) {
+  OfflineStreamPtr stream(SherpaOnnxCreateOfflineStream(recognizer));
+  if (!stream) {
+    throw std::runtime_error("Failed to create offline stream");
+  }
 
-  // Cleanup
-  SherpaOnnxDestroyOfflineRecognizerResult(result);
-  SherpaOnnxDestroyOfflineStream(stream);
-  SherpaOnnxFreeWave(wave);
+  SherpaOnnxAcceptWaveformOffline(stream.get(), sample_rate, samples, n);
+  SherpaOnnxDecodeOfflineStream(recognizer, stream.get());
 
-  return out;
+  OfflineResultPtr result(SherpaOnnxGetOfflineStreamResult(stream.get()));
+  if (!result) {
+    throw std::runtime_error("Failed to get recognition result");
+  }
+
+  return copy_result(result.get());
 }
 
-// Transcribe raw audio samples
+// Decode several waveforms in one multi-stream call without the R API
+// Each waveform gets its own stream; sherpa-onnx batches the streams
+// through the model together. Throws std::runtime_error on failure.
+std::vector<DecodedResult> decode_waveforms_native(
+    const SherpaOnnxOfflineRecognizer *recognizer, int sample_rate,
+    const std::vector<const std::vector<float> *> &waveforms) {
+  std::vector<OfflineStreamPtr> streams;
+  std::vector<const SherpaOnnxOfflineStream *> raw;
+  streams.reserve(waveforms.size());
+  raw.reserve(waveforms.size());
+
+  for (const std::vector<float> *samples : waveforms) {
+    streams.emplace_back(SherpaOnnxCreateOfflineStream(recognizer));
+    if (!streams.back()) {
+      throw std::runtime_error("Failed to create offline stream");
+    }
+    SherpaOnnxAcceptWaveformOffline(streams.back().get(), sample_rate, samples->data(),
+                                    static_cast<int32_t>(samples->size()));
+    raw.push_back(streams.back().get());
+  }
+
+  SherpaOnnxDecodeMultipleOfflineStreams(recognizer, raw.data(),
+                                         static_cast<int32_t>(raw.size()));
+
+  std::vector<DecodedResult> results;
+  results.reserve(streams.size());
+  for (const OfflineStreamPtr &stream : streams) {
+    OfflineResultPtr result(SherpaOnnxGetOfflineStreamResult(stream.get()));
+    if (!result) {
+      throw std::runtime_error("Failed to get recognition result");
+    }
+    results.push_back(copy_result(result.get()));
+  }
+
+  return results;
+}
+
+// Transcribe a WAV file
 // Returns a list with transcription results
 [[cpp11::register]]
-list transcribe_samples_(SEXP recognizer_xptr, doubles samples, int sample_rate) {
+list transcribe_wav_(SEXP recognizer_xptr, std::string wav_path, bool words) {
   // Get recognizer from external pointer
-  external_pointer<const SherpaOnnxOfflineRecognizer> recognizer(recognizer_xptr);
+  const SherpaOnnxOfflineRecognizer *recognizer =
+      get_recognizer_handle(recognizer_xptr)->recognizer;
 
-  if (recognizer.get() == nullptr) {
-    stop("Invalid recognizer pointer");
+  // Validate WAV file format before processing
+  if (!is_valid_wav(wav_path)) {
+    stop("Invalid WAV file: %s\nOnly standard WAV files (16-bit PCM, mono/stereo) are supported.\nFile must have RIFF/WAVE headers.", wav_path.c_str());
   }
 
+  // Read WAV file
+  WavePtr wave(SherpaOnnxReadWave(wav_path.c_str()));
+  if (!wave) {
+    stop("Failed to read WAV file: %s", wav_path.c_str());
+  }
+  inject_fault("wave");
+
+  return decode_waveform(recognizer, wave->sample_rate, wave->samples,
+                         wave->num_samples, words);
+}
+
+// Transcribe raw audio samples
+// Returns a list with transcription results
+[[cpp11::register]]
+list transcribe_samples_(SEXP recognizer_xptr, doubles samples, int sample_rate,
+                         bool words) {
+  // Get recognizer from external pointer
+  const SherpaOnnxOfflineRecognizer *recognizer =
+      get_recognizer_handle(recognizer_xptr)->recognizer;
+
   if (samples.size() == 0) {
     stop("Empty audio samples");
   }
 
   // Convert R doubles to float array
   std::vector<float> samples_vec(samples.size());
-  for (size_t i = 0; i < samples.size(); ++i) {
+  for (R_xlen_t i = 0; i < samples.size(); ++i) {
     samples_vec[i] = static_cast<float>(samples[i]);
   }
 
-  // Create stream
-  const SherpaOnnxOfflineStream *stream =
-      SherpaOnnxCreateOfflineStream(recognizer.get());
-
-  if (stream == nullptr) {
-    stop("Failed to create offline stream");
-  }
+  return decode_waveform(recognizer, sample_rate, samples_vec.data(),
+                         static_cast<int32_t>(samples_vec.size()), words);
+}
 
-  // Accept waveform
-  SherpaOnnxAcceptWaveformOffline(
-      stream,
-      sample_rate,
-      samples_vec.data(),
-      samples_vec.size());
+// Parse a complete WAV file held in an R raw vector
+static WavBuffer parse_wav_raw(raws data) {
+  const char *bytes = reinterpret_cast<const char *>(RAW(data));
+  const size_t size = static_cast<size_t>(data.size());
 
-  // Decode
-  SherpaOnnxDecodeOfflineStream(recognizer.get(), stream);
+  // Same header validation as for files
+  if (!is_valid_wav_header(bytes, size)) {
+    stop("Invalid WAV data\nOnly standard WAV files (PCM or 32-bit float) are supported.\nData must start with RIFF/WAVE headers.");
+  }
 
-  // Get result
-  const SherpaOnnxOfflineRecognizerResult *result =
-      SherpaOnnxGetOfflineStreamResult(stream);
+  try {
+    return parse_wav(bytes, size, "<raw vector>");
+  } catch (const std::runtime_error &e) {
+    stop("%s", e.what());
+  }
+}
 
-  // Convert result to R list using helper
-  writable::list out = convert_result_to_list(result);
+// Transcribe a WAV file held in a raw vector, without writing it to disk
+// Returns a list with transcription results
+[[cpp11::register]]
+list transcribe_wav_raw_(SEXP recognizer_xptr, raws data, bool words) {
+  const SherpaOnnxOfflineRecognizer *recognizer =
+      get_recognizer_handle(recognizer_xptr)->recognizer;
 
-  // Cleanup
-  SherpaOnnxDestroyOfflineRecognizerResult(result);
-  SherpaOnnxDestroyOfflineStream(stream);
+  WavBuffer wav = parse_wav_raw(data);
+  if (wav.samples.empty()) {
+    stop("Empty audio samples");
+  }
 
-  return out;
+  return decode_waveform(recognizer, wav.sample_rate, wav.samples.data(),
+                         static_cast<int32_t>(wav.samples.size()), words);
 }
 
 // Destroy a recognizer (explicit cleanup)
 [[cpp11::register]]
 void destroy_recognizer_(SEXP recognizer_xptr) {
-  external_pointer<const SherpaOnnxOfflineRecognizer> recognizer(recognizer_xptr);
+  external_pointer<RecognizerHandle> handle(recognizer_xptr);
 
-  if (recognizer.get() != nullptr) {
-    SherpaOnnxDestroyOfflineRecognizer(recognizer.get());
-    recognizer.release();
+  if (handle.get() != nullptr) {
+    delete handle.release();
   }
 }
 
@@ -327,16 +427,17 @@ list read_wav_(std::string wav_path) {
     stop("Invalid WAV file: %s\nOnly standard WAV files (16-bit PCM, mono/stereo) are supported.\nFile must have RIFF/WAVE headers.", wav_path.c_str());
   }
 
-  const SherpaOnnxWave *wave = SherpaOnnxReadWave(wav_path.c_str());
+  WavePtr wave(SherpaOnnxReadWave(wav_path.c_str()));
 
-  if (wave == nullptr) {
+  if (!wave) {
     stop("Failed to read WAV file: %s", wav_path.c_str());
   }
+  inject_fault("wave");
 
   // Convert samples to R vector
-  writable::doubles samples_vec;
+  writable::doubles samples_vec(static_cast<R_xlen_t>(wave->num_samples));
   for (int32_t i = 0; i < wave->num_samples; ++i) {
-    samples_vec.push_back(wave->samples[i]);
+    samples_vec[i] = wave->samples[i];
   }
 
   writable::list out;
@@ -344,7 +445,87 @@ list read_wav_(std::string wav_path) {
   out.push_back({"sample_rate"_nm = wave->sample_rate});
   out.push_back({"num_samples"_nm = wave->num_samples});
 
-  SherpaOnnxFreeWave(wave);
+  return out;
+}
+
+// Read a WAV file held in a raw vector; same result as read_wav_()
+[[cpp11::register]]
+list read_wav_raw_(raws data) {
+  WavBuffer wav = parse_wav_raw(data);
+
+  writable::doubles samples_vec(static_cast<R_xlen_t>(wav.samples.size()));
+  for (size_t i = 0; i < wav.samples.size(); ++i) {
+    samples_vec[i] = wav.samples[i];
+  }
+
+  writable::list out;
+  out.push_back({"samples"_nm = samples_vec});
+  out.push_back({"sample_rate"_nm = wav.sample_rate});
+  out.push_back({"num_samples"_nm = static_cast<int>(wav.samples.size())});
+
+  return out;
+}
+
+// Read the header of a WAV file without loading any samples
+[[cpp11::register]]
+list wav_info_(std::string wav_path) {
+  try {
+    WavReader reader(wav_path);
+
+    writable::list out;
+    out.push_back({"sample_rate"_nm = reader.sample_rate()});
+    out.push_back({"num_samples"_nm = static_cast<double>(reader.num_frames())});
+    out.push_back({"num_channels"_nm = reader.channels()});
+    return out;
+  } catch (const std::runtime_error &e) {
+    stop("%s", e.what());
+  }
+}
+
+// Read regions of a WAV file, seeking to each one instead of loading the
+// whole file. `starts` and `durations` are in seconds and clamped to the
+// audio; `channels` are 1-based. Returns a list of sample vectors.
+[[cpp11::register]]
+list read_wav_segments_(std::string wav_path, doubles starts, doubles durations,
+                        integers channels) {
+  const R_xlen_t n = starts.size();
+  if (durations.size() != n || channels.size() != n) {
+    stop("starts, durations and channels must have the same length");
+  }
+
+  // One reader per channel, opened on first use
+  std::vector<std::unique_ptr<WavReader>> readers;
+  writable::list out(n);
+  std::vector<float> buffer;
+
+  try {
+    for (R_xlen_t i = 0; i < n; ++i) {
+      const int channel = channels[i] - 1;
+      if (channel < 0) {
+        stop("Channels are 1-based: %d", channels[i]);
+      }
+      if (static_cast<size_t>(channel) >= readers.size()) {
+        readers.resize(channel + 1);
+      }
+      if (!readers[channel]) {
+        readers[channel].reset(new WavReader(wav_path, channel));
+      }
+      WavReader &reader = *readers[channel];
+
+      const double rate = reader.sample_rate();
+      const int64_t first = static_cast<int64_t>(std::llround(starts[i] * rate));
+      const int64_t last = std::min<int64_t>(
+          reader.num_frames(), static_cast<int64_t>(std::llround((starts[i] + durations[i]) * rate)));
+      const size_t count = last > first ? static_cast<size_t>(last - first) : 0;
+
+      reader.seek(first);
+      buffer.resize(count);
+      buffer.resize(reader.read(buffer.data(), count));
+      out[i] = writable::doubles(buffer.begin(), buffer.end());
+    }
+  } catch (const std::runtime_error &e) {
+    stop("%s", e.what());
+  }
 
   return out;
 }
@@ -0,0 +1,88 @@
+// Shared declarations for the sherpa-onnx offline recognizer wrapper
+
+#ifndef SHERPA_ONNX_R_RECOGNIZER_H_
+#define SHERPA_ONNX_R_RECOGNIZER_H_
+
+#include "handles.h"
+#include <sherpa-onnx/c-api/c-api.h>
+#include <cpp11.hpp>
+#include <string>
+#include <vector>
+
+// Recognizer owned by an R external pointer, together with the settings it
+// was created with (reported by recognizer_info_())
+struct RecognizerHandle {
+  const SherpaOnnxOfflineRecognizer *recognizer = nullptr;
+  std::string model_type;
+  std::string provider;
+  int num_threads = 1;
+  std::string decoding_method;
+  int max_active_paths = 4;
+  // Estimated native memory (model file sizes), see native_memory_register()
+  double native_bytes = 0;
+  int native_epoch = 0;
+
+  ~RecognizerHandle() {
+    if (recognizer != nullptr) {
+      SherpaOnnxDestroyOfflineRecognizer(recognizer);
+      native_memory_release(native_bytes, native_epoch);
+    }
+  }
+};
+
+// Get the recognizer handle behind an external pointer
+// Errors if the pointer is invalid or the recognizer has been destroyed
+inline RecognizerHandle *get_recognizer_handle(SEXP recognizer_xptr) {
+  cpp11::external_pointer<RecognizerHandle> handle(recognizer_xptr);
+
+  if (handle.get() == nullptr || handle->recognizer == nullptr) {
+    cpp11::stop("Invalid recognizer pointer");
+  }
+
+  return handle.get();
+}
+
+// Recognition result copied out of sherpa-onnx into plain C++ containers,
+// so it can be produced on worker threads and converted to R later
+struct DecodedResult {
+  std::string text;
+  std::vector<std::string> tokens;
+  std::vector<double> timestamps;
+  std::vector<double> durations;
+  bool has_timestamps = false;
+  bool has_durations = false;
+  std::string language;
+  std::string emotion;
+  std::string event;
+  std::string json;
+  bool has_json = false;
+};
+
+// The functions below are defined in recognizer.cpp
+
+// Copy a sherpa-onnx result (no R API; safe on worker threads)
+DecodedResult copy_result(const SherpaOnnxOfflineRecognizerResult *result);
+
+// Convert a result to an R list; with `words`, word-level fields are
+// appended (see words.h)
+cpp11::writable::list decoded_result_to_list(const DecodedResult &result, bool words);
+cpp11::writable::list convert_result_to_list(const SherpaOnnxOfflineRecognizerResult *result,
+                                             bool words);
+
+// Decode one waveform and convert the result
+cpp11::writable::list decode_waveform(const SherpaOnnxOfflineRecognizer *recognizer,
+                                      int sample_rate, const float *samples, int32_t n,
+                                      bool words);
+
+// Decode one waveform without the R API (safe on worker threads)
+// Throws std::runtime_error on failure
+DecodedResult decode_waveform_native(const SherpaOnnxOfflineRecognizer *recognizer,
+                                     int sample_rate, const float *samples, int32_t n);
+
+// Decode several waveforms together with multi-stream decoding (no R API)
+// Results are in input order. Throws std::runtime_error on failure
+std::vector<DecodedResult> decode_waveforms_native(
+    const SherpaOnnxOfflineRecognizer *recognizer, int sample_rate,
+    const std::vector<const std::vector<float> *> &waveforms);
+
+#endif  // SHERPA_ONNX_R_RECOGNIZER_H_
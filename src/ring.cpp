@@ -0,0 +1,156 @@
+// Consumer of shared-memory audio rings
+// Uses cpp11 for R interface (producer side for R processes)
+
+#include "ring.h"
+#include <cpp11.hpp>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+using namespace cpp11;
+
+#ifdef _WIN32
+
+struct sherpa_onnx_ring {};
+
+RingReader::RingReader(const std::string &name) : name_(name) {
+  throw std::runtime_error("Shared-memory rings are not supported on Windows");
+}
+
+RingReader::~RingReader() {}
+
+bool RingReader::read_header() { return false; }
+
+bool RingReader::eof() const { return false; }
+
+size_t RingReader::read(float *, size_t) { return 0; }
+
+#else
+
+#include "../inst/include/sherpa_onnx_ring.h"
+
+static_assert(sizeof(sherpa_onnx_ring_header) == SHERPA_ONNX_RING_HEADER_SIZE,
+              "ring header layout");
+
+RingReader::RingReader(const std::string &name) : name_(name) {
+  if (name.size() < 2 || name[0] != '/' || name.find('/', 1) != std::string::npos) {
+    throw std::runtime_error("Ring names look like \"/name\": " + name);
+  }
+}
+
+RingReader::~RingReader() {
+  if (ring_) {
+    sherpa_onnx_ring_release(ring_.get());
+  }
+}
+
+bool RingReader::read_header() {
+  if (ring_) {
+    return true;
+  }
+
+  std::unique_ptr<sherpa_onnx_ring> ring(new sherpa_onnx_ring());
+  if (sherpa_onnx_ring_open(ring.get(), name_.c_str()) != 0) {
+    // Not created yet, or created but not yet initialized
+    if (errno == ENOENT || errno == EINVAL) {
+      return false;
+    }
+    throw std::runtime_error("Failed to open ring " + name_ + ": " + strerror(errno));
+  }
+
+  sample_rate_ = static_cast<int>(ring->header->sample_rate);
+  ring_ = std::move(ring);
+  return true;
+}
+
+bool RingReader::eof() const {
+  return ring_ && sherpa_onnx_ring_closed(ring_.get()) &&
+         sherpa_onnx_ring_available(ring_.get()) == 0;
+}
+
+size_t RingReader::read(float *out, size_t max_frames) {
+  if (!read_header()) {
+    return 0;
+  }
+  const size_t got = static_cast<size_t>(sherpa_onnx_ring_read(ring_.get(), out, max_frames));
+  position_ += static_cast<int64_t>(got);
+  return got;
+}
+
+#endif  // _WIN32
+
+// Producer side for R processes (e.g. a capture loop in another R session)
+
+// A ring created by this process; unmapped when garbage collected
+struct RingProducer {
+  sherpa_onnx_ring ring;
+  bool mapped = false;
+
+  ~RingProducer() {
+#ifndef _WIN32
+    if (mapped) {
+      sherpa_onnx_ring_release(&ring);
+    }
+#endif
+  }
+};
+
+static RingProducer *get_ring_producer(SEXP ring_xptr) {
+  external_pointer<RingProducer> producer(ring_xptr);
+  if (producer.get() == nullptr || !producer->mapped) {
+    stop("Invalid or closed ring pointer");
+  }
+  return producer.get();
+}
+
+// Create a ring and return a producer handle
+[[cpp11::register]]
+SEXP ring_create_(std::string name, double capacity, int sample_rate) {
+#ifdef _WIN32
+  stop("Shared-memory rings are not supported on Windows");
+#else
+  std::unique_ptr<RingProducer> producer(new RingProducer());
+  if (sherpa_onnx_ring_create(&producer->ring, name.c_str(),
+                              static_cast<uint64_t>(capacity),
+                              static_cast<uint32_t>(sample_rate)) != 0) {
+    stop("Failed to create ring %s: %s", name.c_str(), strerror(errno));
+  }
+  producer->mapped = true;
+  return external_pointer<RingProducer>(producer.release());
+#endif
+}
+
+// Write samples without blocking; returns how many fitted
+[[cpp11::register]]
+double ring_write_(SEXP ring_xptr, doubles samples) {
+  RingProducer *producer = get_ring_producer(ring_xptr);
+  std::vector<float> data(samples.size());
+  for (R_xlen_t i = 0; i < samples.size(); ++i) {
+    data[i] = static_cast<float>(samples[i]);
+  }
+#ifdef _WIN32
+  (void)producer;
+  return 0;
+#else
+  return static_cast<double>(sherpa_onnx_ring_write(&producer->ring, data.data(), data.size()));
+#endif
+}
+
+// Mark the stream finished and unmap the ring; with `unlink`, also
+// remove its name (consumers that have it open keep reading)
+[[cpp11::register]]
+void ring_close_(SEXP ring_xptr, std::string name, bool unlink) {
+  external_pointer<RingProducer> producer(ring_xptr);
+  if (producer.get() == nullptr || !producer->mapped) {
+    return;
+  }
+#ifndef _WIN32
+  sherpa_onnx_ring_close_writer(&producer->ring);
+  sherpa_onnx_ring_release(&producer->ring);
+  producer->mapped = false;
+  if (unlink) {
+    sherpa_onnx_ring_unlink(name.c_str());
+  }
+#endif
+}
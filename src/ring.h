@@ -0,0 +1,40 @@
+// Consumer of shared-memory audio rings (inst/include/sherpa_onnx_ring.h)
+
+#ifndef SHERPA_ONNX_R_RING_H_
+#define SHERPA_ONNX_R_RING_H_
+
+#include "source.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+struct sherpa_onnx_ring;
+
+// Reads the samples a producer process writes into a named ring
+//
+// The ring is opened lazily: until the producer has created it,
+// read_header() returns false. Reads copy what is available straight from
+// the mapping and never block. POSIX only: on Windows the constructor
+// throws. Does not use the R API; errors throw std::runtime_error.
+class RingReader : public StreamSource {
+ public:
+  explicit RingReader(const std::string &name);
+  ~RingReader() override;
+
+  RingReader(const RingReader &) = delete;
+  RingReader &operator=(const RingReader &) = delete;
+
+  bool read_header() override;
+  int sample_rate() const override { return sample_rate_; }
+  int64_t position() const override { return position_; }
+  bool eof() const override;
+  size_t read(float *out, size_t max_frames) override;
+
+ private:
+  std::string name_;
+  std::unique_ptr<sherpa_onnx_ring> ring_;
+  int sample_rate_ = 0;
+  int64_t position_ = 0;
+};
+
+#endif  // SHERPA_ONNX_R_RING_H_
@@ -0,0 +1,208 @@
+// C++ helpers for inspecting the linked sherpa-onnx / onnxruntime build
+// Uses cpp11 for R interface
+
+#include "recognizer.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#ifndef HWCAP_ASIMDDP
+#define HWCAP_ASIMDDP (1 << 20)
+#endif
+#endif
+
+#if defined(__aarch64__) && defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+
+// onnxruntime_c_api.h is fetched by configure; the prebuilt sherpa-onnx
+// archives ship the onnxruntime library but not its headers
+#include <onnxruntime_c_api.h>
+
+// Oldest OrtApi version with every entry used below: GetAvailableProviders
+// and ReleaseAvailableProviders were added in API 4 (onnxruntime 1.4)
+static const uint32_t kOrtApiVersion = 4;
+
+using namespace cpp11;
+
+// onnxruntime execution provider names and the provider strings that
+// sherpa-onnx accepts for them
+struct ProviderName {
+  const char *ort_name;
+  const char *sherpa_name;
+};
+
+static const ProviderName kProviderNames[] = {
+  {"CPUExecutionProvider", "cpu"},
+  {"CUDAExecutionProvider", "cuda"},
+  {"CoreMLExecutionProvider", "coreml"},
+  {"XnnpackExecutionProvider", "xnnpack"},
+  {"NnapiExecutionProvider", "nnapi"},
+  {"TensorrtExecutionProvider", "trt"},
+  {"DmlExecutionProvider", "directml"},
+};
+
+// Map an onnxruntime provider name to the sherpa-onnx provider string
+// Returns an empty string for providers sherpa-onnx cannot select
+static std::string sherpa_provider_name(const char *ort_name) {
+  for (const ProviderName &p : kProviderNames) {
+    if (strcmp(p.ort_name, ort_name) == 0) {
+      return p.sherpa_name;
+    }
+  }
+  return "";
+}
+
+// List the execution providers compiled into the linked onnxruntime
+// Returns a list with `probed` (FALSE if the linked onnxruntime is too old
+// to report its providers), `ort_name` and `provider` (sherpa-onnx name, "" if none)
+[[cpp11::register]]
+list ort_providers_() {
+  writable::strings ort_names;
+  writable::strings provider_names;
+  bool probed = false;
+
+  // GetApi() returns NULL if the library is older than kOrtApiVersion
+  const OrtApi *api = OrtGetApiBase()->GetApi(kOrtApiVersion);
+  if (api != nullptr) {
+    char **providers = nullptr;
+    int num_providers = 0;
+    OrtStatus *status = api->GetAvailableProviders(&providers, &num_providers);
+    if (status == nullptr) {
+      probed = true;
+      for (int i = 0; i < num_providers; ++i) {
+        ort_names.push_back(std::string(providers[i]));
+        provider_names.push_back(sherpa_provider_name(providers[i]));
+      }
+      status = api->ReleaseAvailableProviders(providers, num_providers);
+    }
+    if (status != nullptr) {
+      api->ReleaseStatus(status);
+    }
+  }
+
+  writable::list out;
+  out.push_back({"probed"_nm = probed});
+  out.push_back({"ort_name"_nm = ort_names});
+  out.push_back({"provider"_nm = provider_names});
+
+  return out;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Check that the OS saves the given XCR0 state bits on context switch
+static bool os_supports_xsave_state(uint64_t mask) {
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_OSXSAVE)) {
+    return false;
+  }
+  uint32_t xcr0_lo, xcr0_hi;
+  __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+  uint64_t xcr0 = (static_cast<uint64_t>(xcr0_hi) << 32) | xcr0_lo;
+  return (xcr0 & mask) == mask;
+}
+#endif
+
+// Detect the CPU instruction set extensions that onnxruntime kernels use
+// Returns a named list of logicals; features of other architectures are FALSE
+[[cpp11::register]]
+list cpu_features_() {
+  bool avx2 = false, fma = false, avx512f = false, avx512_vnni = false;
+  bool avx_vnni = false, neon = false, dotprod = false;
+  std::string arch = "unknown";
+
+#if defined(__x86_64__) || defined(__i386__)
+#if defined(__x86_64__)
+  arch = "x86_64";
+#else
+  arch = "i386";
+#endif
+  unsigned int eax, ebx, ecx, edx;
+
+  // YMM state (bits 1-2) for AVX; opmask and ZMM state (bits 5-7) for AVX-512
+  bool os_avx = os_supports_xsave_state(0x6);
+  bool os_avx512 = os_supports_xsave_state(0xE6);
+
+  if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+    fma = os_avx && (ecx & (1u << 12));
+  }
+  if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+    avx2 = os_avx && (ebx & (1u << 5));
+    avx512f = os_avx512 && (ebx & (1u << 16));
+    avx512_vnni = os_avx512 && (ecx & (1u << 11));
+  }
+  if (__get_cpuid_count(7, 1, &eax, &ebx, &ecx, &edx)) {
+    avx_vnni = os_avx && (eax & (1u << 4));
+  }
+#elif defined(__aarch64__)
+  arch = "aarch64";
+  // Advanced SIMD is mandatory on AArch64
+  neon = true;
+#if defined(__linux__)
+  dotprod = (getauxval(AT_HWCAP) & HWCAP_ASIMDDP) != 0;
+#elif defined(__APPLE__)
+  int value = 0;
+  size_t size = sizeof(value);
+  if (sysctlbyname("hw.optional.arm.FEAT_DotProd", &value, &size, nullptr, 0) == 0) {
+    dotprod = value != 0;
+  }
+#endif
+#endif
+
+  writable::list out;
+  out.push_back({"arch"_nm = arch});
+  out.push_back({"avx2"_nm = avx2});
+  out.push_back({"fma"_nm = fma});
+  out.push_back({"avx512f"_nm = avx512f});
+  out.push_back({"avx512_vnni"_nm = avx512_vnni});
+  out.push_back({"avx_vnni"_nm = avx_vnni});
+  out.push_back({"neon"_nm = neon});
+  out.push_back({"dotprod"_nm = dotprod});
+
+  return out;
+}
+
+// Report how the linked sherpa-onnx and onnxruntime libraries were built
+[[cpp11::register]]
+list library_info_() {
+  writable::list out;
+  out.push_back({"sherpa_onnx_version"_nm = std::string(SherpaOnnxGetVersionStr())});
+  out.push_back({"sherpa_onnx_git_sha1"_nm = std::string(SherpaOnnxGetGitSha1())});
+  out.push_back({"sherpa_onnx_git_date"_nm = std::string(SherpaOnnxGetGitDate())});
+  out.push_back({"onnxruntime_version"_nm =
+                     std::string(OrtGetApiBase()->GetVersionString())});
+
+  // configure defines SHERPA_ONNX_R_SYSTEM_LIB when SHERPA_ONNX_USE_SYSTEM=1
+#ifdef SHERPA_ONNX_R_SYSTEM_LIB
+  out.push_back({"binary_source"_nm = std::string("system")});
+#else
+  out.push_back({"binary_source"_nm = std::string("download")});
+#endif
+
+  out.push_back({"hardware_threads"_nm =
+                     static_cast<int>(std::thread::hardware_concurrency())});
+
+  return out;
+}
+
+// Report the settings a recognizer was created with
+[[cpp11::register]]
+list recognizer_info_(SEXP recognizer_xptr) {
+  RecognizerHandle *handle = get_recognizer_handle(recognizer_xptr);
+
+  writable::list out;
+  out.push_back({"model_type"_nm = handle->model_type});
+  out.push_back({"provider"_nm = handle->provider});
+  out.push_back({"num_threads"_nm = handle->num_threads});
+  out.push_back({"decoding_method"_nm = handle->decoding_method});
+  out.push_back({"max_active_paths"_nm = handle->max_active_paths});
+
+  return out;
+}
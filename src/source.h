@@ -0,0 +1,33 @@
+// Audio sources that deliver samples as they arrive
+
+#ifndef SHERPA_ONNX_R_SOURCE_H_
+#define SHERPA_ONNX_R_SOURCE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Non-blocking source of mono float samples for followed streams
+// Implementations must not use the R API; errors throw
+// std::runtime_error.
+class StreamSource {
+ public:
+  virtual ~StreamSource() {}
+
+  // Try to get ready (read a header, open a ring); returns whether the
+  // source is ready to deliver samples
+  virtual bool read_header() = 0;
+
+  // Only valid once read_header() returned true
+  virtual int sample_rate() const = 0;
+
+  // Frames returned so far
+  virtual int64_t position() const = 0;
+
+  // True once the writer is done and every frame has been returned
+  virtual bool eof() const = 0;
+
+  // Read up to `max_frames` frames that are available without blocking
+  virtual size_t read(float *out, size_t max_frames) = 0;
+};
+
+#endif  // SHERPA_ONNX_R_SOURCE_H_
@@ -0,0 +1,128 @@
+// C++ wrapper for incremental offline streams
+// Uses cpp11 for R interface
+
+#include "recognizer.h"
+#include <cmath>
+#include <vector>
+
+using namespace cpp11;
+
+// Audio accumulated for one offline decode
+//
+// sherpa-onnx computes features and finishes the input on the first
+// AcceptWaveform() of an offline stream, so audio cannot be appended to it
+// piecewise. The handle buffers samples natively instead and hands them to
+// a sherpa-onnx stream in one call at decode time.
+struct StreamHandle {
+  std::vector<float> samples;
+  int sample_rate = 0;
+  bool decoded = false;
+};
+
+// Get the stream handle behind an external pointer
+static StreamHandle *get_stream_handle(SEXP stream_xptr) {
+  external_pointer<StreamHandle> handle(stream_xptr);
+
+  if (handle.get() == nullptr) {
+    stop("Invalid stream pointer");
+  }
+
+  return handle.get();
+}
+
+// Create an offline stream for a recognizer
+// The recognizer's external pointer is kept alive by the stream's pointer
+[[cpp11::register]]
+SEXP create_offline_stream_(SEXP recognizer_xptr) {
+  // Validate the recognizer now rather than at decode time
+  get_recognizer_handle(recognizer_xptr);
+
+  external_pointer<StreamHandle> ptr(new StreamHandle());
+  R_SetExternalPtrProtected(ptr, recognizer_xptr);
+
+  return ptr;
+}
+
+// Append samples to a stream; can be called any number of times
+// `start` and `end` (1-based, inclusive) select a range of `samples`,
+// so callers can append part of a vector without copying it in R
+[[cpp11::register]]
+void stream_accept_waveform_(SEXP stream_xptr, doubles samples, int sample_rate,
+                             double start, double end) {
+  StreamHandle *handle = get_stream_handle(stream_xptr);
+
+  if (handle->decoded) {
+    stop("Stream has already been decoded; create a new stream");
+  }
+  if (sample_rate <= 0) {
+    stop("sample_rate must be positive");
+  }
+  if (handle->sample_rate != 0 && handle->sample_rate != sample_rate) {
+    stop("Sample rate %d does not match the stream's sample rate %d",
+         sample_rate, handle->sample_rate);
+  }
+
+  // Check in double precision first: casting NA, NaN or an out-of-range
+  // value to an integer type is undefined
+  if (!std::isfinite(start) || !std::isfinite(end) || start != std::floor(start) ||
+      end != std::floor(end)) {
+    stop("start and end must be whole numbers");
+  }
+  const R_xlen_t n = samples.size();
+  if (start < 1 || end > static_cast<double>(n) || start - 1 > end) {
+    stop("Sample range [%.0f, %.0f] is out of bounds", start, end);
+  }
+  const R_xlen_t from = static_cast<R_xlen_t>(start) - 1;
+  const R_xlen_t to = static_cast<R_xlen_t>(end);
+
+  handle->sample_rate = sample_rate;
+  handle->samples.reserve(handle->samples.size() + (to - from));
+
+  const double *data = REAL(samples);
+  for (R_xlen_t i = from; i < to; ++i) {
+    handle->samples.push_back(static_cast<float>(data[i]));
+  }
+}
+
+// Number of samples buffered in a stream
+[[cpp11::register]]
+double stream_num_samples_(SEXP stream_xptr) {
+  return static_cast<double>(get_stream_handle(stream_xptr)->samples.size());
+}
+
+// Decode all buffered audio
+// Returns a list with transcription results; the buffer is released
+[[cpp11::register]]
+list stream_decode_(SEXP stream_xptr, bool words) {
+  StreamHandle *handle = get_stream_handle(stream_xptr);
+
+  if (handle->decoded) {
+    stop("Stream has already been decoded; create a new stream");
+  }
+  if (handle->samples.empty()) {
+    stop("Empty audio samples");
+  }
+
+  const SherpaOnnxOfflineRecognizer *recognizer =
+      get_recognizer_handle(R_ExternalPtrProtected(stream_xptr))->recognizer;
+
+  writable::list out = decode_waveform(
+      recognizer, handle->sample_rate, handle->samples.data(),
+      static_cast<int32_t>(handle->samples.size()), words);
+
+  handle->decoded = true;
+  std::vector<float>().swap(handle->samples);
+
+  return out;
+}
+
+// Release a stream's buffer (explicit cleanup)
+[[cpp11::register]]
+void destroy_stream_(SEXP stream_xptr) {
+  external_pointer<StreamHandle> handle(stream_xptr);
+
+  if (handle.get() != nullptr) {
+    delete handle.release();
+  }
+  R_SetExternalPtrProtected(stream_xptr, R_NilValue);
+}
@@ -0,0 +1,321 @@
+// Incremental transcription of WAV files that are still being written
+// Uses cpp11 for R interface
+
+#include "fd.h"
+#include "recognizer.h"
+#include "ring.h"
+#include "vad.h"
+#include "wav.h"
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace cpp11;
+
+// Closed segments are decoded in multi-stream batches of at most this many
+// segments, longest first, like transcribe_utterances_()
+static const size_t kTailBatchSize = 8;
+
+// State of one followed file or stream
+//
+// The file is reopened lazily until its header is complete; streams
+// (pipes, FIFOs, descriptors, shared-memory rings) are read through
+// `stream` instead. Each poll
+// reads only the frames appended since the last one, feeds them through a
+// persistent VAD (keeping partial windows in `pending`) and decodes the
+// segments the VAD has closed.
+struct TailHandle {
+  std::string path;
+  std::string vad_model_path;
+  SherpaOnnxVadModelConfig vad_config;
+  std::unique_ptr<WavReader> reader;
+  std::unique_ptr<StreamSource> stream;
+  bool checked_rate = false;
+  VadPtr vad;
+  std::vector<float> pending;
+  int window_size = 512;
+  bool finished = false;
+};
+
+static TailHandle *get_tail_handle(SEXP tail_xptr) {
+  external_pointer<TailHandle> handle(tail_xptr);
+
+  if (handle.get() == nullptr) {
+    stop("Invalid tail pointer");
+  }
+
+  return handle.get();
+}
+
+// Set up the VAD of a new tail
+static std::unique_ptr<TailHandle> new_tail_handle(SEXP recognizer_xptr,
+                                                   const std::string &vad_model_path,
+                                                   double vad_threshold, double vad_min_silence,
+                                                   double vad_min_speech, double vad_max_speech,
+                                                   int vad_window_size) {
+  get_recognizer_handle(recognizer_xptr);
+
+  std::unique_ptr<TailHandle> handle(new TailHandle());
+  handle->vad_model_path = vad_model_path;
+  handle->window_size = vad_window_size;
+  // Silero models run at 16 kHz; the input's rate is checked once known
+  handle->vad_config = make_vad_config(handle->vad_model_path, 16000, vad_threshold,
+                                       vad_min_silence, vad_min_speech,
+                                       vad_max_speech, vad_window_size);
+
+  handle->vad.reset(SherpaOnnxCreateVoiceActivityDetector(&handle->vad_config, 60.0f));
+  if (!handle->vad) {
+    stop("Failed to create VAD instance. Check model path: %s", vad_model_path.c_str());
+  }
+  inject_fault("vad");
+
+  return handle;
+}
+
+// Follow a WAV file with a recognizer and a Silero VAD
+// The recognizer's external pointer is kept alive by the tail's pointer
+[[cpp11::register]]
+SEXP create_wav_tail_(SEXP recognizer_xptr, std::string wav_path,
+                      std::string vad_model_path, double vad_threshold,
+                      double vad_min_silence, double vad_min_speech,
+                      double vad_max_speech, int vad_window_size) {
+  std::unique_ptr<TailHandle> handle =
+      new_tail_handle(recognizer_xptr, vad_model_path, vad_threshold, vad_min_silence,
+                      vad_min_speech, vad_max_speech, vad_window_size);
+  handle->path = wav_path;
+
+  external_pointer<TailHandle> ptr(handle.release());
+  R_SetExternalPtrProtected(ptr, recognizer_xptr);
+
+  return ptr;
+}
+
+// Follow a pipe, FIFO or file descriptor carrying WAV or headerless PCM
+// Opens `path` if not empty, else reads descriptor `fd`; see FdReader
+[[cpp11::register]]
+SEXP create_fd_tail_(SEXP recognizer_xptr, std::string path, int fd, std::string format,
+                     int sample_rate, int channels, std::string vad_model_path,
+                     double vad_threshold, double vad_min_silence, double vad_min_speech,
+                     double vad_max_speech, int vad_window_size) {
+  std::unique_ptr<TailHandle> handle =
+      new_tail_handle(recognizer_xptr, vad_model_path, vad_threshold, vad_min_silence,
+                      vad_min_speech, vad_max_speech, vad_window_size);
+  handle->path = path;
+
+  try {
+    handle->stream.reset(new FdReader(path, fd, format, sample_rate, channels));
+  } catch (const std::runtime_error &e) {
+    stop("%s", e.what());
+  }
+
+  external_pointer<TailHandle> ptr(handle.release());
+  R_SetExternalPtrProtected(ptr, recognizer_xptr);
+
+  return ptr;
+}
+
+// Follow a shared-memory ring written by another process
+// The ring may be created after the tail; see RingReader
+[[cpp11::register]]
+SEXP create_ring_tail_(SEXP recognizer_xptr, std::string name, std::string vad_model_path,
+                       double vad_threshold, double vad_min_silence, double vad_min_speech,
+                       double vad_max_speech, int vad_window_size) {
+  std::unique_ptr<TailHandle> handle =
+      new_tail_handle(recognizer_xptr, vad_model_path, vad_threshold, vad_min_silence,
+                      vad_min_speech, vad_max_speech, vad_window_size);
+  handle->path = name;
+
+  try {
+    handle->stream.reset(new RingReader(name));
+  } catch (const std::runtime_error &e) {
+    stop("%s", e.what());
+  }
+
+  external_pointer<TailHandle> ptr(handle.release());
+  R_SetExternalPtrProtected(ptr, recognizer_xptr);
+
+  return ptr;
+}
+
+// Decode closed segments in bounded, length-sorted batches
+// Segment audio is released as soon as its batch is decoded. Throws
+// std::runtime_error on failure (no R API).
+static std::vector<DecodedResult> decode_segments(
+    const SherpaOnnxOfflineRecognizer *recognizer, std::vector<SegmentBounds> &segments) {
+  const size_t n = segments.size();
+  std::vector<size_t> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return segments[a].samples.size() > segments[b].samples.size();
+  });
+
+  std::vector<DecodedResult> results(n);
+  for (size_t first = 0; first < n; first += kTailBatchSize) {
+    const size_t last = std::min(n, first + kTailBatchSize);
+    std::vector<const std::vector<float> *> waveforms;
+    for (size_t k = first; k < last; ++k) {
+      waveforms.push_back(&segments[order[k]].samples);
+    }
+    std::vector<DecodedResult> batch = decode_waveforms_native(recognizer, 16000, waveforms);
+    for (size_t k = first; k < last; ++k) {
+      results[order[k]] = std::move(batch[k - first]);
+      std::vector<float>().swap(segments[order[k]].samples);
+    }
+  }
+  return results;
+}
+
+// Process audio appended to the file (or sent to the stream) since the
+// last call
+// At most `max_frames` frames are read per call; `more` is TRUE when the
+// call stopped there, and the caller should poll again without waiting.
+// With `flush`, the VAD is flushed so the last open segment is decoded
+// too and the tail is finished (only once `more` is FALSE, so a flushing
+// call may need repeating until `finished` is TRUE). Returns a list with
+// the new segments' start_time, duration and results, the frames read so
+// far, and whether a stream's writer has closed it (`ended`).
+[[cpp11::register]]
+list wav_tail_poll_(SEXP tail_xptr, bool flush, bool words, double max_frames) {
+  TailHandle *handle = get_tail_handle(tail_xptr);
+  if (handle->finished) {
+    stop("Tail has been finished");
+  }
+
+  SEXP recognizer_xptr = R_ExternalPtrProtected(tail_xptr);
+  const SherpaOnnxOfflineRecognizer *recognizer =
+      get_recognizer_handle(recognizer_xptr)->recognizer;
+
+  if (!(max_frames >= 1)) {
+    stop("max_frames must be at least 1");
+  }
+
+  // Open once the header (fmt and data chunk headers) has been written
+  if (!handle->stream && !handle->reader) {
+    try {
+      handle->reader.reset(new WavReader(handle->path));
+    } catch (const std::runtime_error &e) {
+      if (flush) {
+        stop("%s", e.what());
+      }
+    }
+    if (handle->reader && handle->reader->sample_rate() != 16000) {
+      handle->reader.reset();
+      stop("Following requires 16 kHz audio: %s", handle->path.c_str());
+    }
+  }
+
+  // Streams are checked once their header has arrived
+  bool ready = handle->reader != nullptr;
+  if (handle->stream) {
+    try {
+      ready = handle->stream->read_header();
+    } catch (const std::runtime_error &e) {
+      stop("%s", e.what());
+    }
+    if (ready && !handle->checked_rate) {
+      if (handle->stream->sample_rate() != 16000) {
+        stop("Following requires 16 kHz audio, got %d Hz", handle->stream->sample_rate());
+      }
+      handle->checked_rate = true;
+    }
+  }
+
+  std::vector<SegmentBounds> segments;
+  const size_t window = static_cast<size_t>(handle->window_size);
+  const double limit = std::min(max_frames, 9007199254740992.0);
+  double read_frames = 0;
+  bool more = false;
+
+  if (ready) {
+    if (handle->reader) {
+      handle->reader->refresh();
+    }
+
+    // Same windows as vad(): a window is fed once a sample follows it
+    for (;;) {
+      if (read_frames >= limit) {
+        more = true;
+        break;
+      }
+      const size_t block = static_cast<size_t>(
+          std::min<double>(static_cast<double>(window * 64), limit - read_frames));
+      const size_t have = handle->pending.size();
+      handle->pending.resize(have + block);
+      size_t got = 0;
+      try {
+        got = handle->reader ? handle->reader->read(handle->pending.data() + have, block)
+                             : handle->stream->read(handle->pending.data() + have, block);
+      } catch (const std::runtime_error &e) {
+        handle->pending.resize(have);
+        stop("%s", e.what());
+      }
+      handle->pending.resize(have + got);
+      if (got == 0) {
+        break;
+      }
+      read_frames += static_cast<double>(got);
+
+      size_t offset = 0;
+      for (; offset + window < handle->pending.size(); offset += window) {
+        SherpaOnnxVoiceActivityDetectorAcceptWaveform(
+            handle->vad.get(), handle->pending.data() + offset, handle->window_size);
+        collect_segments(handle->vad.get(), true, segments);
+      }
+      handle->pending.erase(handle->pending.begin(), handle->pending.begin() + offset);
+    }
+  }
+
+  if (flush && !more) {
+    SherpaOnnxVoiceActivityDetectorFlush(handle->vad.get());
+    collect_segments(handle->vad.get(), true, segments);
+    handle->finished = true;
+  }
+
+  std::vector<DecodedResult> results;
+  try {
+    results = decode_segments(recognizer, segments);
+  } catch (const std::runtime_error &e) {
+    stop("%s", e.what());
+  }
+
+  writable::doubles starts(static_cast<R_xlen_t>(segments.size()));
+  writable::doubles durations(static_cast<R_xlen_t>(segments.size()));
+  writable::list result_list(static_cast<R_xlen_t>(segments.size()));
+  for (size_t i = 0; i < segments.size(); ++i) {
+    starts[i] = segments[i].start / 16000.0;
+    durations[i] = segments[i].n / 16000.0;
+    result_list[i] = decoded_result_to_list(results[i], words);
+  }
+
+  double frames = 0;
+  if (handle->reader) {
+    frames = static_cast<double>(handle->reader->position());
+  } else if (handle->stream) {
+    frames = static_cast<double>(handle->stream->position());
+  }
+
+  writable::list out;
+  out.push_back({"start_time"_nm = starts});
+  out.push_back({"duration"_nm = durations});
+  out.push_back({"results"_nm = result_list});
+  out.push_back({"num_samples"_nm = frames});
+  out.push_back({"opened"_nm = ready});
+  out.push_back({"ended"_nm = handle->stream != nullptr && handle->stream->eof()});
+  out.push_back({"more"_nm = more});
+  out.push_back({"finished"_nm = handle->finished});
+
+  return out;
+}
+
+// Destroy a tail (explicit cleanup)
+[[cpp11::register]]
+void destroy_wav_tail_(SEXP tail_xptr) {
+  external_pointer<TailHandle> handle(tail_xptr);
+
+  if (handle.get() != nullptr) {
+    delete handle.release();
+  }
+}
@@ -1,40 +1,23 @@
 // C++ wrapper for sherpa-onnx Voice Activity Detection (VAD)
 // Uses cpp11 for R interface
 
-#include <sherpa-onnx/c-api/c-api.h>
+#include "vad.h"
+#include "pool.h"
+#include "wav.h"
 #include <cpp11.hpp>
 #include <memory>
 #include <string>
 #include <vector>
 #include <cstring>
+#include <algorithm>
+#include <exception>
 
 using namespace cpp11;
 
-// Extract VAD segments from audio samples
-// Returns a list of segments, each with samples, start_time, and duration
-[[cpp11::register]]
-list extract_vad_segments_(
-    std::string vad_model_path,
-    doubles samples,
-    int sample_rate,
-    double vad_threshold,
-    double vad_min_silence,
-    double vad_min_speech,
-    double vad_max_speech,
-    int vad_window_size,
-    bool verbose) {
-
-  if (samples.size() == 0) {
-    stop("Empty audio samples");
-  }
-
-  // Convert R doubles to float array
-  std::vector<float> samples_vec(samples.size());
-  for (size_t i = 0; i < samples.size(); ++i) {
-    samples_vec[i] = static_cast<float>(samples[i]);
-  }
-
-  // Create VAD configuration
+SherpaOnnxVadModelConfig make_vad_config(
+    const std::string &vad_model_path, int sample_rate, double vad_threshold,
+    double vad_min_silence, double vad_min_speech, double vad_max_speech,
+    int vad_window_size) {
   SherpaOnnxVadModelConfig vad_config;
   memset(&vad_config, 0, sizeof(vad_config));
 
@@ -50,13 +33,103 @@ list extract_vad_segments_(
   vad_config.num_threads = 1;
   vad_config.debug = 0;  // Don't print C++ debug output
 
+  return vad_config;
+}
+
+void collect_segments(const SherpaOnnxVoiceActivityDetector *vad, bool keep_samples,
+                      std::vector<SegmentBounds> &segments) {
+  while (!SherpaOnnxVoiceActivityDetectorEmpty(vad)) {
+    SpeechSegmentPtr segment(SherpaOnnxVoiceActivityDetectorFront(vad));
+    SherpaOnnxVoiceActivityDetectorPop(vad);
+
+    SegmentBounds bounds;
+    bounds.start = segment->start;
+    bounds.n = segment->n;
+    if (keep_samples) {
+      bounds.samples.assign(segment->samples, segment->samples + segment->n);
+    }
+    segments.push_back(std::move(bounds));
+  }
+}
+
+// Stream a WAV file through a VAD in blocks, so memory does not depend on
+// the file length. Feeds exactly the windows extract_vad_segments_() would: a window
+// is fed once at least one more sample follows it, then the rest is flushed.
+// `on_segment` receives each finished segment (no R API).
+template <typename F>
+static void run_vad_stream(const SherpaOnnxVoiceActivityDetector *vad,
+                           WavReader &reader, int window_size, bool keep_samples,
+                           F on_segment) {
+  const size_t window = static_cast<size_t>(window_size);
+  const size_t block = window * 64;
+  std::vector<float> pending;
+  std::vector<SegmentBounds> found;
+
+  for (;;) {
+    const size_t have = pending.size();
+    pending.resize(have + block);
+    const size_t got = reader.read(pending.data() + have, block);
+    pending.resize(have + got);
+    if (got == 0) {
+      break;
+    }
+
+    size_t offset = 0;
+    for (; offset + window < pending.size(); offset += window) {
+      SherpaOnnxVoiceActivityDetectorAcceptWaveform(vad, pending.data() + offset,
+                                                    window_size);
+      collect_segments(vad, keep_samples, found);
+    }
+    pending.erase(pending.begin(), pending.begin() + offset);
+
+    for (SegmentBounds &seg : found) {
+      on_segment(seg);
+    }
+    found.clear();
+  }
+
+  SherpaOnnxVoiceActivityDetectorFlush(vad);
+  collect_segments(vad, keep_samples, found);
+  for (SegmentBounds &seg : found) {
+    on_segment(seg);
+  }
+}
+
+// Create one detector per worker on the main thread
+static std::vector<VadPtr> create_vad_pool(const SherpaOnnxVadModelConfig &vad_config,
+                                           size_t workers,
+                                           const std::string &vad_model_path) {
+  std::vector<VadPtr> vads;
+  for (size_t w = 0; w < workers; ++w) {
+    vads.emplace_back(SherpaOnnxCreateVoiceActivityDetector(&vad_config, 60.0f));
+    if (!vads.back()) {
+      stop("Failed to create VAD instance. Check model path: %s", vad_model_path.c_str());
+    }
+  }
+  inject_fault("vad");
+  return vads;
+}
+
+list vad_segment_list(const std::string &vad_model_path, const std::vector<float> &samples_vec,
+                      int sample_rate, double vad_threshold, double vad_min_silence,
+                      double vad_min_speech, double vad_max_speech, int vad_window_size,
+                      bool verbose) {
+  if (samples_vec.empty()) {
+    stop("Empty audio samples");
+  }
+
+  // Create VAD configuration
+  SherpaOnnxVadModelConfig vad_config = make_vad_config(
+      vad_model_path, sample_rate, vad_threshold, vad_min_silence,
+      vad_min_speech, vad_max_speech, vad_window_size);
+
   // Create VAD instance (buffer size = 60 seconds to handle batching)
-  const SherpaOnnxVoiceActivityDetector *vad =
-      SherpaOnnxCreateVoiceActivityDetector(&vad_config, 60.0f);
+  VadPtr vad(SherpaOnnxCreateVoiceActivityDetector(&vad_config, 60.0f));
 
-  if (vad == nullptr) {
+  if (!vad) {
     stop("Failed to create VAD instance. Check model path: %s", vad_model_path.c_str());
   }
+  inject_fault("vad");
 
   // Collect all VAD segments
   writable::list segments_list;
@@ -68,22 +141,23 @@ list extract_vad_segments_(
     // Feed audio to VAD in windows
     if (i + vad_window_size < samples_vec.size()) {
       SherpaOnnxVoiceActivityDetectorAcceptWaveform(
-          vad, samples_vec.data() + i, vad_window_size);
+          vad.get(), samples_vec.data() + i, vad_window_size);
     } else {
       // Last chunk - flush VAD
-      SherpaOnnxVoiceActivityDetectorFlush(vad);
+      SherpaOnnxVoiceActivityDetectorFlush(vad.get());
       is_eof = 1;
     }
 
     // Collect all available speech segments
-    while (!SherpaOnnxVoiceActivityDetectorEmpty(vad)) {
-      const SherpaOnnxSpeechSegment *segment =
-          SherpaOnnxVoiceActivityDetectorFront(vad);
+    while (!SherpaOnnxVoiceActivityDetectorEmpty(vad.get())) {
+      SpeechSegmentPtr segment(SherpaOnnxVoiceActivityDetectorFront(vad.get()));
+      SherpaOnnxVoiceActivityDetectorPop(vad.get());
+      inject_fault("segment");
 
       // Convert samples to R doubles
-      writable::doubles seg_samples;
+      writable::doubles seg_samples(static_cast<R_xlen_t>(segment->n));
       for (int32_t j = 0; j < segment->n; ++j) {
-        seg_samples.push_back(segment->samples[j]);
+        seg_samples[j] = segment->samples[j];
       }
 
       // Calculate times
@@ -98,17 +172,11 @@ list extract_vad_segments_(
 
       segments_list.push_back(seg_info);
       num_segments++;
-
-      SherpaOnnxDestroySpeechSegment(segment);
-      SherpaOnnxVoiceActivityDetectorPop(vad);
     }
 
     i += vad_window_size;
   }
 
-  // Cleanup VAD
-  SherpaOnnxDestroyVoiceActivityDetector(vad);
-
   if (verbose) {
     Rprintf("VAD detected %d speech segments\n", num_segments);
   }
@@ -121,3 +189,261 @@ list extract_vad_segments_(
   return out;
 }
 
+// Extract VAD segments from audio samples
+// Returns a list of segments, each with samples, start_time, and duration
+[[cpp11::register]]
+list extract_vad_segments_(
+    std::string vad_model_path,
+    doubles samples,
+    int sample_rate,
+    double vad_threshold,
+    double vad_min_silence,
+    double vad_min_speech,
+    double vad_max_speech,
+    int vad_window_size,
+    bool verbose) {
+
+  // Convert R doubles to float array
+  std::vector<float> samples_vec(samples.size());
+  for (size_t i = 0; i < samples.size(); ++i) {
+    samples_vec[i] = static_cast<float>(samples[i]);
+  }
+
+  return vad_segment_list(vad_model_path, samples_vec, sample_rate, vad_threshold,
+                          vad_min_silence, vad_min_speech, vad_max_speech, vad_window_size,
+                          verbose);
+}
+
+
+// Silero models run at 16 kHz; files at other rates are reported as errors
+static const int kVadSampleRate = 16000;
+
+// Per-file outcome of run_vad_files()
+struct VadFileInfo {
+  int sample_rate = 0;
+  int64_t num_samples = 0;
+  std::string error;
+};
+
+// Stream many WAV files through a pool of persistent Silero instances
+// Shared by vad_batch_() and vad_summary_(), which only differ in what
+// they keep of each segment. Each worker owns one detector and resets it
+// between files. `on_segment(file, segment)` runs on worker threads, but
+// all segments of one file come from the same worker, in order, so it may
+// write to per-file state without locking (no R API).
+template <typename F>
+static std::vector<VadFileInfo> run_vad_files(
+    const std::string &vad_model_path, const std::vector<std::string> &paths,
+    double vad_threshold, double vad_min_silence, double vad_min_speech,
+    double vad_max_speech, int vad_window_size, int num_workers, bool keep_samples,
+    F on_segment) {
+  const size_t n = paths.size();
+  SherpaOnnxVadModelConfig vad_config = make_vad_config(
+      vad_model_path, kVadSampleRate, vad_threshold, vad_min_silence,
+      vad_min_speech, vad_max_speech, vad_window_size);
+
+  // One detector per worker, created up front on the main thread
+  const size_t workers = std::max<size_t>(1, std::min<size_t>(std::max(num_workers, 1), n));
+  std::vector<VadPtr> vads = create_vad_pool(vad_config, workers, vad_model_path);
+
+  std::vector<VadFileInfo> files(n);
+
+  parallel_for_workers(n, static_cast<int>(workers), [&](size_t worker, size_t i) {
+    VadFileInfo &file = files[i];
+    try {
+      WavReader reader(paths[i]);
+      file.sample_rate = reader.sample_rate();
+      file.num_samples = reader.num_frames();
+      if (file.sample_rate != kVadSampleRate) {
+        file.error = "VAD requires 16 kHz audio: " + paths[i];
+        return;
+      }
+
+      const SherpaOnnxVoiceActivityDetector *vad = vads[worker].get();
+      SherpaOnnxVoiceActivityDetectorReset(vad);
+      run_vad_stream(vad, reader, vad_window_size, keep_samples,
+                     [&](SegmentBounds &seg) { on_segment(i, seg); });
+    } catch (const std::exception &e) {
+      file.error = e.what();
+    }
+  });
+
+  return files;
+}
+
+static std::vector<std::string> as_paths(strings wav_paths) {
+  std::vector<std::string> paths(wav_paths.size());
+  for (R_xlen_t i = 0; i < wav_paths.size(); ++i) {
+    paths[i] = std::string(wav_paths[i]);
+  }
+  return paths;
+}
+
+// Run VAD over many WAV files on a pool of persistent Silero instances
+// Files are streamed natively, so samples are only copied to R with
+// `keep_samples`. Returns flat per-segment vectors (file index, start,
+// duration and optionally samples) and per-file sample_rate, num_samples
+// and error.
+[[cpp11::register]]
+list vad_batch_(
+    std::string vad_model_path,
+    strings wav_paths,
+    double vad_threshold,
+    double vad_min_silence,
+    double vad_min_speech,
+    double vad_max_speech,
+    int vad_window_size,
+    int num_workers,
+    bool keep_samples) {
+
+  const std::vector<std::string> paths = as_paths(wav_paths);
+  const size_t n = paths.size();
+
+  std::vector<std::vector<SegmentBounds>> segments(n);
+  const std::vector<VadFileInfo> files = run_vad_files(
+      vad_model_path, paths, vad_threshold, vad_min_silence, vad_min_speech,
+      vad_max_speech, vad_window_size, num_workers, keep_samples,
+      [&](size_t i, SegmentBounds &seg) { segments[i].push_back(std::move(seg)); });
+
+  // Flatten segments into per-segment columns
+  size_t total = 0;
+  for (const std::vector<SegmentBounds> &file_segments : segments) {
+    total += file_segments.size();
+  }
+
+  writable::integers file_index(static_cast<R_xlen_t>(total));
+  writable::doubles starts(static_cast<R_xlen_t>(total));
+  writable::doubles durations(static_cast<R_xlen_t>(total));
+  writable::list samples_list(keep_samples ? static_cast<R_xlen_t>(total) : 0);
+
+  writable::integers sample_rates(static_cast<R_xlen_t>(n));
+  writable::doubles num_samples(static_cast<R_xlen_t>(n));
+  writable::strings errors(static_cast<R_xlen_t>(n));
+
+  R_xlen_t k = 0;
+  for (size_t i = 0; i < n; ++i) {
+    sample_rates[i] = files[i].sample_rate;
+    num_samples[i] = static_cast<double>(files[i].num_samples);
+    if (files[i].error.empty()) {
+      errors[i] = NA_STRING;
+    } else {
+      errors[i] = files[i].error;
+    }
+
+    for (const SegmentBounds &seg : segments[i]) {
+      file_index[k] = static_cast<int>(i) + 1;
+      starts[k] = seg.start / static_cast<double>(kVadSampleRate);
+      durations[k] = seg.n / static_cast<double>(kVadSampleRate);
+      if (keep_samples) {
+        samples_list[k] = writable::doubles(seg.samples.begin(), seg.samples.end());
+      }
+      ++k;
+    }
+  }
+
+  writable::list out;
+  out.push_back({"file_index"_nm = file_index});
+  out.push_back({"start_time"_nm = starts});
+  out.push_back({"duration"_nm = durations});
+  if (keep_samples) {
+    out.push_back({"samples"_nm = samples_list});
+  } else {
+    out.push_back({"samples"_nm = R_NilValue});
+  }
+  out.push_back({"sample_rate"_nm = sample_rates});
+  out.push_back({"num_samples"_nm = num_samples});
+  out.push_back({"error"_nm = errors});
+
+  return out;
+}
+
+
+// Aggregate VAD statistics for one file of a summary
+struct VadSummaryStats {
+  int64_t speech_samples = 0;
+  int num_segments = 0;
+  std::vector<int64_t> starts;  // only filled with boundaries
+  std::vector<int32_t> lengths;
+};
+
+// Summarize speech in many WAV files without keeping any audio
+// Like vad_batch_(), but only counts (and optionally segment boundaries)
+// are kept, so memory is independent of file length. Returns per-file
+// sample_rate, num_samples, speech_samples, num_segments and error, plus
+// flat file_index, start_time and duration vectors with `boundaries`.
+[[cpp11::register]]
+list vad_summary_(
+    std::string vad_model_path,
+    strings wav_paths,
+    double vad_threshold,
+    double vad_min_silence,
+    double vad_min_speech,
+    double vad_max_speech,
+    int vad_window_size,
+    int num_workers,
+    bool boundaries) {
+
+  const std::vector<std::string> paths = as_paths(wav_paths);
+  const size_t n = paths.size();
+
+  std::vector<VadSummaryStats> stats(n);
+  const std::vector<VadFileInfo> files = run_vad_files(
+      vad_model_path, paths, vad_threshold, vad_min_silence, vad_min_speech,
+      vad_max_speech, vad_window_size, num_workers, false,
+      [&](size_t i, SegmentBounds &seg) {
+        VadSummaryStats &file = stats[i];
+        file.speech_samples += seg.n;
+        file.num_segments++;
+        if (boundaries) {
+          file.starts.push_back(seg.start);
+          file.lengths.push_back(seg.n);
+        }
+      });
+
+  writable::integers sample_rates(static_cast<R_xlen_t>(n));
+  writable::doubles num_samples(static_cast<R_xlen_t>(n));
+  writable::doubles speech_samples(static_cast<R_xlen_t>(n));
+  writable::integers num_segments(static_cast<R_xlen_t>(n));
+  writable::strings errors(static_cast<R_xlen_t>(n));
+
+  size_t total = 0;
+  for (size_t i = 0; i < n; ++i) {
+    sample_rates[i] = files[i].sample_rate;
+    num_samples[i] = static_cast<double>(files[i].num_samples);
+    speech_samples[i] = static_cast<double>(stats[i].speech_samples);
+    num_segments[i] = stats[i].num_segments;
+    if (files[i].error.empty()) {
+      errors[i] = NA_STRING;
+    } else {
+      errors[i] = files[i].error;
+    }
+    total += stats[i].starts.size();
+  }
+
+  writable::list out;
+  out.push_back({"sample_rate"_nm = sample_rates});
+  out.push_back({"num_samples"_nm = num_samples});
+  out.push_back({"speech_samples"_nm = speech_samples});
+  out.push_back({"num_segments"_nm = num_segments});
+  out.push_back({"error"_nm = errors});
+
+  if (boundaries) {
+    writable::integers file_index(static_cast<R_xlen_t>(total));
+    writable::doubles starts(static_cast<R_xlen_t>(total));
+    writable::doubles durations(static_cast<R_xlen_t>(total));
+    R_xlen_t k = 0;
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t j = 0; j < stats[i].starts.size(); ++j) {
+        file_index[k] = static_cast<int>(i) + 1;
+        starts[k] = stats[i].starts[j] / static_cast<double>(kVadSampleRate);
+        durations[k] = stats[i].lengths[j] / static_cast<double>(kVadSampleRate);
+        ++k;
+      }
+    }
+    out.push_back({"file_index"_nm = file_index});
+    out.push_back({"start_time"_nm = starts});
+    out.push_back({"duration"_nm = durations});
+  }
+
+  return out;
+}
@@ -0,0 +1,40 @@
+// Shared declarations for the sherpa-onnx VAD wrappers
+
+#ifndef SHERPA_ONNX_R_VAD_H_
+#define SHERPA_ONNX_R_VAD_H_
+
+#include "handles.h"
+#include <cpp11.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Speech segment found by a VAD, in samples
+struct SegmentBounds {
+  int32_t start;
+  int32_t n;
+  std::vector<float> samples;  // only filled with keep_samples
+};
+
+// The functions below are defined in vad.cpp
+
+// Silero VAD configuration; `vad_model_path` must outlive the config
+SherpaOnnxVadModelConfig make_vad_config(
+    const std::string &vad_model_path, int sample_rate, double vad_threshold,
+    double vad_min_silence, double vad_min_speech, double vad_max_speech,
+    int vad_window_size);
+
+// Move all finished segments out of a VAD (no R API)
+void collect_segments(const SherpaOnnxVoiceActivityDetector *vad, bool keep_samples,
+                      std::vector<SegmentBounds> &segments);
+
+// Run a VAD over audio held in memory, as extract_vad_segments_()
+// Returns list(segments, num_segments), each segment a list with samples,
+// start_time and duration; uses the R API
+cpp11::list vad_segment_list(const std::string &vad_model_path,
+                             const std::vector<float> &samples, int sample_rate,
+                             double vad_threshold, double vad_min_silence,
+                             double vad_min_speech, double vad_max_speech,
+                             int vad_window_size, bool verbose);
+
+#endif  // SHERPA_ONNX_R_VAD_H_
@@ -0,0 +1,198 @@
+// Multi-stream VAD engine: many independent audio streams stepped together
+// Uses cpp11 for R interface
+
+#include "vad.h"
+#include "pool.h"
+#include <cpp11.hpp>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace cpp11;
+
+// One audio stream: its own detector (and therefore its own Silero
+// recurrent state) plus samples that do not yet fill a whole window
+struct VadStream {
+  VadPtr vad;
+  std::vector<float> pending;
+};
+
+// Engine holding the streams
+//
+// The sherpa-onnx C API evaluates Silero one detector at a time and does not
+// expose the recurrent state, so windows of different streams cannot be
+// stacked into one model invocation. Instead each call advances every
+// stream that received audio, spread over `num_workers` threads, so a
+// single native call does the work of one VAD call per stream.
+struct VadStreamsHandle {
+  std::vector<VadStream> streams;
+  int window_size = 512;
+  int sample_rate = 16000;
+  int num_workers = 1;
+};
+
+static VadStreamsHandle *get_vad_streams_handle(SEXP xptr) {
+  external_pointer<VadStreamsHandle> handle(xptr);
+
+  if (handle.get() == nullptr) {
+    stop("Invalid VAD streams pointer");
+  }
+
+  return handle.get();
+}
+
+// Convert per-stream segments to flat columns
+static writable::list segments_to_list(const std::vector<std::vector<SegmentBounds>> &found,
+                                       int sample_rate, bool keep_samples) {
+  size_t total = 0;
+  for (const auto &segments : found) {
+    total += segments.size();
+  }
+
+  writable::integers stream_index(static_cast<R_xlen_t>(total));
+  writable::doubles starts(static_cast<R_xlen_t>(total));
+  writable::doubles durations(static_cast<R_xlen_t>(total));
+  writable::list samples_list(keep_samples ? static_cast<R_xlen_t>(total) : 0);
+
+  R_xlen_t k = 0;
+  for (size_t s = 0; s < found.size(); ++s) {
+    for (const SegmentBounds &seg : found[s]) {
+      stream_index[k] = static_cast<int>(s) + 1;
+      starts[k] = seg.start / static_cast<double>(sample_rate);
+      durations[k] = seg.n / static_cast<double>(sample_rate);
+      if (keep_samples) {
+        samples_list[k] = writable::doubles(seg.samples.begin(), seg.samples.end());
+      }
+      ++k;
+    }
+  }
+
+  writable::list out;
+  out.push_back({"stream"_nm = stream_index});
+  out.push_back({"start_time"_nm = starts});
+  out.push_back({"duration"_nm = durations});
+  if (keep_samples) {
+    out.push_back({"samples"_nm = samples_list});
+  } else {
+    out.push_back({"samples"_nm = R_NilValue});
+  }
+
+  return out;
+}
+
+// Create an engine with `num_streams` independent 16 kHz streams
+[[cpp11::register]]
+SEXP create_vad_streams_(
+    std::string vad_model_path,
+    int num_streams,
+    double vad_threshold,
+    double vad_min_silence,
+    double vad_min_speech,
+    double vad_max_speech,
+    int vad_window_size,
+    int num_workers) {
+
+  if (num_streams < 1) {
+    stop("num_streams must be at least 1");
+  }
+
+  std::unique_ptr<VadStreamsHandle> handle(new VadStreamsHandle());
+  handle->window_size = vad_window_size;
+  handle->num_workers = std::max(num_workers, 1);
+
+  SherpaOnnxVadModelConfig vad_config = make_vad_config(
+      vad_model_path, handle->sample_rate, vad_threshold, vad_min_silence,
+      vad_min_speech, vad_max_speech, vad_window_size);
+
+  handle->streams.resize(num_streams);
+  for (VadStream &stream : handle->streams) {
+    stream.vad.reset(SherpaOnnxCreateVoiceActivityDetector(&vad_config, 60.0f));
+    if (!stream.vad) {
+      stop("Failed to create VAD instance. Check model path: %s", vad_model_path.c_str());
+    }
+  }
+
+  external_pointer<VadStreamsHandle> ptr(handle.release());
+  return ptr;
+}
+
+// Append audio to the streams and return the segments they completed
+// `chunks` has one element per stream: a numeric vector, or NULL for no audio
+[[cpp11::register]]
+list vad_streams_accept_(SEXP xptr, list chunks, bool keep_samples) {
+  VadStreamsHandle *handle = get_vad_streams_handle(xptr);
+  const size_t n = handle->streams.size();
+
+  if (static_cast<size_t>(chunks.size()) != n) {
+    stop("Expected %d chunks (one per stream), got %d",
+         static_cast<int>(n), static_cast<int>(chunks.size()));
+  }
+
+  // Copy the new audio into each stream's pending buffer on the main thread
+  std::vector<size_t> active;
+  for (size_t s = 0; s < n; ++s) {
+    SEXP chunk = chunks[s];
+    if (chunk == R_NilValue) {
+      continue;
+    }
+    doubles samples(chunk);
+    if (samples.size() == 0) {
+      continue;
+    }
+    std::vector<float> &pending = handle->streams[s].pending;
+    pending.insert(pending.end(), samples.begin(), samples.end());
+    active.push_back(s);
+  }
+
+  std::vector<std::vector<SegmentBounds>> found(n);
+  const size_t window = static_cast<size_t>(handle->window_size);
+
+  parallel_for(active.size(), handle->num_workers, [&](size_t a) {
+    const size_t s = active[a];
+    VadStream &stream = handle->streams[s];
+
+    // Feed whole windows but always keep at least one sample back, so the
+    // window vad() drops at end of input is dropped here too at flush
+    size_t i = 0;
+    for (; i + window < stream.pending.size(); i += window) {
+      SherpaOnnxVoiceActivityDetectorAcceptWaveform(
+          stream.vad.get(), stream.pending.data() + i, handle->window_size);
+      collect_segments(stream.vad.get(), keep_samples, found[s]);
+    }
+    stream.pending.erase(stream.pending.begin(), stream.pending.begin() + i);
+  });
+
+  return segments_to_list(found, handle->sample_rate, keep_samples);
+}
+
+// End all streams: flush their detectors, return the final segments and
+// reset the streams so the engine can be reused
+[[cpp11::register]]
+list vad_streams_flush_(SEXP xptr, bool keep_samples) {
+  VadStreamsHandle *handle = get_vad_streams_handle(xptr);
+  const size_t n = handle->streams.size();
+
+  std::vector<std::vector<SegmentBounds>> found(n);
+
+  parallel_for(n, handle->num_workers, [&](size_t s) {
+    VadStream &stream = handle->streams[s];
+    // As in vad(), a trailing partial window is not fed to the model
+    SherpaOnnxVoiceActivityDetectorFlush(stream.vad.get());
+    collect_segments(stream.vad.get(), keep_samples, found[s]);
+    SherpaOnnxVoiceActivityDetectorReset(stream.vad.get());
+    stream.pending.clear();
+  });
+
+  return segments_to_list(found, handle->sample_rate, keep_samples);
+}
+
+// Free the engine's detectors (explicit cleanup)
+[[cpp11::register]]
+void destroy_vad_streams_(SEXP xptr) {
+  external_pointer<VadStreamsHandle> handle(xptr);
+
+  if (handle.get() != nullptr) {
+    delete handle.release();
+  }
+}
@@ -0,0 +1,294 @@
+// Chunked WAV file reader
+
+#include "wav.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// Check the RIFF/WAVE header at the start of a WAV container
+// Returns true if valid, false otherwise
+bool is_valid_wav_header(const char *data, size_t size) {
+  if (size < 12) {
+    return false;
+  }
+
+  // Check for "RIFF" magic bytes (0x52494646)
+  if (data[0] != 'R' || data[1] != 'I' || data[2] != 'F' || data[3] != 'F') {
+    return false;
+  }
+
+  // Check for "WAVE" format (0x57415645)
+  if (data[8] != 'W' || data[9] != 'A' || data[10] != 'V' || data[11] != 'E') {
+    return false;
+  }
+
+  return true;
+}
+
+// Validate that a file is a valid WAV file
+// Returns true if valid, false otherwise
+bool is_valid_wav(const std::string &filename) {
+  std::ifstream file(filename, std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+
+  // Read RIFF header (first 12 bytes)
+  char header[12];
+  file.read(header, 12);
+  if (!file) {
+    return false;
+  }
+
+  return is_valid_wav_header(header, sizeof(header));
+}
+
+static uint32_t read_u32(const char *p) {
+  const unsigned char *b = reinterpret_cast<const unsigned char *>(p);
+  return static_cast<uint32_t>(b[0]) | (static_cast<uint32_t>(b[1]) << 8) |
+         (static_cast<uint32_t>(b[2]) << 16) | (static_cast<uint32_t>(b[3]) << 24);
+}
+
+static uint16_t read_u16(const char *p) {
+  const unsigned char *b = reinterpret_cast<const unsigned char *>(p);
+  return static_cast<uint16_t>(b[0] | (b[1] << 8));
+}
+
+static WavFormat parse_fmt(const char *fmt, uint32_t size) {
+  WavFormat f;
+  f.format = read_u16(fmt);
+  f.channels = read_u16(fmt + 2);
+  f.sample_rate = static_cast<int>(read_u32(fmt + 4));
+  f.bits_per_sample = read_u16(fmt + 14);
+  // WAVE_FORMAT_EXTENSIBLE: the sub-format GUID starts with the format
+  if (f.format == 0xFFFE && size >= 26) {
+    f.format = read_u16(fmt + 24);
+  }
+  return f;
+}
+
+void check_wav_format(const WavFormat &f, int channel, const std::string &name) {
+  const bool is_float = f.format == 3;
+  if (f.format != 1 && !(is_float && f.bits_per_sample == 32)) {
+    throw std::runtime_error("Unsupported WAV encoding (only PCM and 32-bit float): " + name);
+  }
+  if (!is_float && (f.bits_per_sample < 8 || f.bits_per_sample > 32 ||
+                    f.bits_per_sample % 8 != 0)) {
+    throw std::runtime_error("Unsupported WAV sample size: " + name);
+  }
+  if (channel < 0 || channel >= f.channels) {
+    throw std::runtime_error("WAV file has no channel " + std::to_string(channel + 1) + ": " +
+                             name);
+  }
+}
+
+void decode_wav_frames(const char *data, size_t frames, const WavFormat &f, int channel,
+                       float *out) {
+  const int bytes_per_sample = f.bits_per_sample / 8;
+  const size_t bytes_per_frame = static_cast<size_t>(f.channels) * bytes_per_sample;
+  const bool is_float = f.format == 3;
+
+  for (size_t i = 0; i < frames; ++i) {
+    const char *p = data + i * bytes_per_frame + channel * bytes_per_sample;
+    float value;
+    if (is_float) {
+      memcpy(&value, p, sizeof(float));
+    } else if (bytes_per_sample == 1) {
+      // 8-bit PCM is unsigned
+      value = (static_cast<unsigned char>(p[0]) - 128) / 128.0f;
+    } else if (bytes_per_sample == 2) {
+      value = static_cast<int16_t>(read_u16(p)) / 32768.0f;
+    } else if (bytes_per_sample == 3) {
+      int32_t v = static_cast<int32_t>(read_u16(p)) |
+                  (static_cast<int32_t>(static_cast<signed char>(p[2])) << 16);
+      value = v / 8388608.0f;
+    } else {
+      value = static_cast<int32_t>(read_u32(p)) / 2147483648.0f;
+    }
+    out[i] = value;
+  }
+}
+
+bool parse_wav_header(const char *data, size_t size, const std::string &name, int channel,
+                      WavFormat &format, size_t &data_offset, uint32_t &data_size) {
+  if (size < 12) {
+    return false;
+  }
+  if (!is_valid_wav_header(data, size)) {
+    throw std::runtime_error("Invalid WAV file: " + name);
+  }
+
+  // Same chunk walk as WavReader, over the buffer
+  bool have_fmt = false;
+  size_t pos = 12;
+  while (pos + 8 <= size) {
+    const uint32_t chunk_size = read_u32(data + pos + 4);
+    const size_t body = pos + 8;
+
+    if (memcmp(data + pos, "fmt ", 4) == 0) {
+      if (chunk_size > size - body) {
+        return false;
+      }
+      if (chunk_size < 16) {
+        throw std::runtime_error("Invalid WAV fmt chunk: " + name);
+      }
+      format = parse_fmt(data + body, chunk_size);
+      have_fmt = true;
+    } else if (memcmp(data + pos, "data", 4) == 0) {
+      if (!have_fmt || format.channels * (format.bits_per_sample / 8) <= 0) {
+        throw std::runtime_error("WAV file has no fmt/data chunks: " + name);
+      }
+      check_wav_format(format, channel, name);
+      data_offset = body;
+      data_size = chunk_size;
+      return true;
+    }
+
+    // Chunks are padded to an even size
+    const uint64_t next = static_cast<uint64_t>(body) + chunk_size + (chunk_size & 1);
+    if (next > size) {
+      return false;
+    }
+    pos = static_cast<size_t>(next);
+  }
+
+  // Need more bytes
+  return false;
+}
+
+WavBuffer parse_wav(const char *data, size_t size, const std::string &name, int channel) {
+  if (!is_valid_wav_header(data, size)) {
+    throw std::runtime_error("Invalid WAV file: " + name);
+  }
+
+  WavFormat f;
+  size_t offset = 0;
+  uint32_t chunk_size = 0;
+  if (!parse_wav_header(data, size, name, channel, f, offset, chunk_size)) {
+    throw std::runtime_error("WAV file has no fmt/data chunks: " + name);
+  }
+
+  // Unfinalized or truncated data sizes: the buffer length decides
+  size_t data_size = chunk_size;
+  if (chunk_size == 0 || chunk_size == 0xFFFFFFFFu || chunk_size > size - offset) {
+    data_size = size - offset;
+  }
+
+  const size_t bytes_per_frame = static_cast<size_t>(f.channels) * (f.bits_per_sample / 8);
+  WavBuffer out;
+  out.sample_rate = f.sample_rate;
+  out.channels = f.channels;
+  out.samples.resize(data_size / bytes_per_frame);
+  decode_wav_frames(data + offset, out.samples.size(), f, channel, out.samples.data());
+  return out;
+}
+
+WavReader::WavReader(const std::string &path, int channel)
+    : file_(path, std::ios::binary), path_(path), channel_(channel) {
+  if (!file_.is_open()) {
+    throw std::runtime_error("Failed to open WAV file: " + path);
+  }
+
+  char header[12];
+  file_.read(header, 12);
+  if (!file_ || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+    throw std::runtime_error("Invalid WAV file: " + path);
+  }
+
+  // Walk the chunks until the data chunk, reading fmt on the way
+  bool have_fmt = false;
+  WavFormat f;
+  char chunk[8];
+  while (file_.read(chunk, 8)) {
+    const uint32_t size = read_u32(chunk + 4);
+
+    if (memcmp(chunk, "fmt ", 4) == 0) {
+      std::vector<char> fmt(std::max<uint32_t>(size, 16));
+      if (!file_.read(fmt.data(), size)) {
+        break;
+      }
+      f = parse_fmt(fmt.data(), size);
+      channels_ = f.channels;
+      sample_rate_ = f.sample_rate;
+      bits_per_sample_ = f.bits_per_sample;
+      have_fmt = true;
+    } else if (memcmp(chunk, "data", 4) == 0) {
+      if (!have_fmt) {
+        break;
+      }
+      data_offset_ = static_cast<int64_t>(file_.tellg());
+      data_size_pos_ = data_offset_ - 4;
+      if (channels_ * bits_per_sample_ / 8 <= 0) {
+        break;
+      }
+      update_num_frames(size);
+      file_.seekg(data_offset_);
+
+      format_ = f;
+      check_wav_format(f, channel_, path);
+      return;
+    } else {
+      // Chunks are padded to an even size
+      file_.seekg(size + (size & 1), std::ios::cur);
+    }
+  }
+
+  throw std::runtime_error("WAV file has no fmt/data chunks: " + path);
+}
+
+// Streams written without a final size record 0 or 0xFFFFFFFF, and files
+// still being written may hold less than the header claims; in both cases
+// the file length decides
+void WavReader::update_num_frames(uint32_t data_size) {
+  const int64_t bytes_per_frame = static_cast<int64_t>(channels_) * (bits_per_sample_ / 8);
+  file_.clear();
+  file_.seekg(0, std::ios::end);
+  const int64_t available = static_cast<int64_t>(file_.tellg()) - data_offset_;
+
+  num_frames_ = data_size / bytes_per_frame;
+  if (data_size == 0 || data_size == 0xFFFFFFFFu ||
+      available < static_cast<int64_t>(data_size)) {
+    num_frames_ = std::max<int64_t>(0, available) / bytes_per_frame;
+  }
+}
+
+int64_t WavReader::refresh() {
+  // The writer may have finalized the data size since the last look
+  char size_field[4];
+  file_.clear();
+  file_.seekg(data_size_pos_);
+  uint32_t data_size = 0;
+  if (file_.read(size_field, 4)) {
+    data_size = read_u32(size_field);
+  }
+
+  update_num_frames(data_size);
+  seek(position_);
+  return num_frames_;
+}
+
+size_t WavReader::read(float *out, size_t max_frames) {
+  const int64_t remaining = num_frames_ - position_;
+  const size_t frames = static_cast<size_t>(std::min<int64_t>(remaining, max_frames));
+  if (frames == 0) {
+    return 0;
+  }
+
+  const int bytes_per_sample = bits_per_sample_ / 8;
+  const size_t bytes_per_frame = static_cast<size_t>(channels_) * bytes_per_sample;
+  buffer_.resize(frames * bytes_per_frame);
+  file_.read(buffer_.data(), buffer_.size());
+  const size_t got = static_cast<size_t>(file_.gcount()) / bytes_per_frame;
+
+  decode_wav_frames(buffer_.data(), got, format_, channel_, out);
+
+  position_ += got;
+  return got;
+}
+
+void WavReader::seek(int64_t frame) {
+  position_ = std::max<int64_t>(0, std::min(frame, num_frames_));
+  const int64_t bytes_per_frame = static_cast<int64_t>(channels_) * (bits_per_sample_ / 8);
+  file_.clear();
+  file_.seekg(data_offset_ + position_ * bytes_per_frame);
+}
@@ -0,0 +1,97 @@
+// Chunked WAV file reader
+
+#ifndef SHERPA_ONNX_R_WAV_H_
+#define SHERPA_ONNX_R_WAV_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Check for RIFF/WAVE headers, in a file or at the start of a buffer
+bool is_valid_wav(const std::string &filename);
+bool is_valid_wav_header(const char *data, size_t size);
+
+// Format fields of a fmt chunk (`format` 1 is PCM, 3 is float)
+struct WavFormat {
+  int format = 0;
+  int channels = 0;
+  int sample_rate = 0;
+  int bits_per_sample = 0;
+};
+
+// Throw std::runtime_error unless the format is 8/16/24/32-bit PCM or
+// 32-bit float with a channel `channel` (0-based); `name` labels errors
+void check_wav_format(const WavFormat &format, int channel, const std::string &name);
+
+// Convert `frames` interleaved frames to floats in [-1, 1) of one channel
+void decode_wav_frames(const char *data, size_t frames, const WavFormat &format, int channel,
+                       float *out);
+
+// Parse the header of a WAV stream held in `data` up to the first sample
+// Returns false if the buffer ends before the data chunk starts (read
+// more and call again); on success sets the format, the offset of the
+// first sample and the data chunk size as written (0 or 0xFFFFFFFF for
+// streams of unknown length). Invalid headers throw std::runtime_error.
+bool parse_wav_header(const char *data, size_t size, const std::string &name, int channel,
+                      WavFormat &format, size_t &data_offset, uint32_t &data_size);
+
+// Samples of one channel of a WAV container decoded in memory
+struct WavBuffer {
+  int sample_rate = 0;
+  int channels = 0;
+  std::vector<float> samples;
+};
+
+// Parse a complete WAV container held in memory (same formats and chunk
+// rules as WavReader; `name` labels errors). Throws std::runtime_error.
+WavBuffer parse_wav(const char *data, size_t size, const std::string &name,
+                    int channel = 0);
+
+// Reads the samples of a WAV file in blocks, so memory does not depend on
+// the file length. Supports 8/16/24/32-bit PCM and 32-bit float; samples
+// are returned as floats in [-1, 1) from one channel (by default the
+// first, like SherpaOnnxReadWave()). Does not use the R API; errors throw
+// std::runtime_error.
+class WavReader {
+ public:
+  explicit WavReader(const std::string &path, int channel = 0);
+
+  int sample_rate() const { return sample_rate_; }
+  int channels() const { return channels_; }
+  int64_t num_frames() const { return num_frames_; }
+  // Frames read (or skipped with seek()) so far
+  int64_t position() const { return position_; }
+  // Byte offset of the first sample in the file
+  int64_t data_offset() const { return data_offset_; }
+
+  // Read up to `max_frames` frames of the selected channel into `out`
+  // Returns the number of frames read; 0 at the end of the data
+  size_t read(float *out, size_t max_frames);
+
+  // Position the reader at frame `frame` (clamped to the data)
+  void seek(int64_t frame);
+
+  // Re-check the file for frames appended since it was opened (for files
+  // still being written); returns the new number of frames
+  int64_t refresh();
+
+ private:
+  std::ifstream file_;
+  std::string path_;
+  int sample_rate_ = 0;
+  int channels_ = 0;
+  int channel_ = 0;
+  int bits_per_sample_ = 0;
+  WavFormat format_;
+  int64_t num_frames_ = 0;
+  int64_t data_offset_ = 0;
+  int64_t data_size_pos_ = 0;
+  int64_t position_ = 0;
+  std::vector<char> buffer_;
+
+  void update_num_frames(uint32_t data_size);
+};
+
+#endif  // SHERPA_ONNX_R_WAV_H_
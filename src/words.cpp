@@ -0,0 +1,232 @@
+// Word-level aggregation of subword tokens
+// Uses cpp11 for R interface
+
+#include "words.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+using namespace cpp11;
+
+// SentencePiece word-boundary marker U+2581 in UTF-8
+static const char kWordMarker[] = "\xe2\x96\x81";
+static const size_t kWordMarkerLen = 3;
+
+// Decode the first UTF-8 code point of a string (0 if empty or invalid)
+static uint32_t first_code_point(const std::string &s) {
+  if (s.empty()) {
+    return 0;
+  }
+
+  const unsigned char c = static_cast<unsigned char>(s[0]);
+  if (c < 0x80) {
+    return c;
+  }
+
+  int len = 0;
+  uint32_t cp = 0;
+  if ((c & 0xE0) == 0xC0) {
+    len = 2;
+    cp = c & 0x1F;
+  } else if ((c & 0xF0) == 0xE0) {
+    len = 3;
+    cp = c & 0x0F;
+  } else if ((c & 0xF8) == 0xF0) {
+    len = 4;
+    cp = c & 0x07;
+  } else {
+    return 0;
+  }
+
+  if (s.size() < static_cast<size_t>(len)) {
+    return 0;
+  }
+  for (int i = 1; i < len; ++i) {
+    cp = (cp << 6) | (static_cast<unsigned char>(s[i]) & 0x3F);
+  }
+  return cp;
+}
+
+// Scripts written without spaces between words: each character is a word.
+// Hangul is not one of them; Korean marks word boundaries with spaces.
+static bool is_cjk(uint32_t cp) {
+  return (cp >= 0x3040 && cp <= 0x30FF) ||   // Hiragana, Katakana
+         (cp >= 0x3400 && cp <= 0x4DBF) ||   // CJK Extension A
+         (cp >= 0x4E00 && cp <= 0x9FFF) ||   // CJK Unified Ideographs
+         (cp >= 0xF900 && cp <= 0xFAFF);     // CJK Compatibility Ideographs
+}
+
+// Special tokens such as <|en|> or <|HAPPY|> carry no text
+static bool is_special_token(const std::string &token) {
+  return token.size() >= 4 && token.compare(0, 2, "<|") == 0 &&
+         token.compare(token.size() - 2, 2, "|>") == 0;
+}
+
+bool starts_with_cjk(const std::string &text) {
+  return is_cjk(first_code_point(text));
+}
+
+size_t utf8_length(const std::string &text) {
+  size_t n = 0;
+  for (unsigned char c : text) {
+    // Count every byte except UTF-8 continuation bytes
+    if ((c & 0xC0) != 0x80) {
+      ++n;
+    }
+  }
+  return n;
+}
+
+WordSpans aggregate_words(const std::vector<std::string> &tokens,
+                          const std::vector<double> &timestamps,
+                          const std::vector<double> &durations) {
+  WordSpans out;
+
+  const bool have_times = !tokens.empty() && timestamps.size() == tokens.size();
+  const bool have_durations = have_times && durations.size() == tokens.size();
+
+  // Without durations the last word has no following token to end at; it
+  // gets the median spacing of the token timestamps
+  double last_word_length = 0.0;
+  if (have_times && !have_durations) {
+    std::vector<double> spacing;
+    for (size_t i = 1; i < timestamps.size(); ++i) {
+      if (timestamps[i] > timestamps[i - 1]) {
+        spacing.push_back(timestamps[i] - timestamps[i - 1]);
+      }
+    }
+    if (!spacing.empty()) {
+      std::nth_element(spacing.begin(), spacing.begin() + spacing.size() / 2, spacing.end());
+      last_word_length = spacing[spacing.size() / 2];
+    }
+  }
+
+  std::string word;
+  bool open = false;
+  bool force_break = false;
+  double word_start = 0.0;
+  double last_token_time = 0.0;
+  double last_token_end = 0.0;
+
+  // Close the current word; `next_start` is the start of the following
+  // token, used as the end time when token durations are unknown
+  auto close_word = [&](double next_start, bool have_next) {
+    if (!open) {
+      return;
+    }
+    out.words.push_back(word);
+    if (have_times) {
+      double end = last_token_time + last_word_length;
+      if (have_durations) {
+        end = last_token_end;
+      } else if (have_next) {
+        end = next_start;
+      }
+      out.starts.push_back(word_start);
+      out.ends.push_back(end);
+      if (have_durations) {
+        out.durations.push_back(end - word_start);
+      }
+    }
+    word.clear();
+    open = false;
+  };
+
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    const std::string &token = tokens[i];
+    if (is_special_token(token)) {
+      continue;
+    }
+
+    size_t offset = 0;
+    bool boundary = false;
+    if (token.compare(0, kWordMarkerLen, kWordMarker) == 0) {
+      offset = kWordMarkerLen;
+      boundary = true;
+    } else if (!token.empty() && token[0] == ' ') {
+      offset = 1;
+      boundary = true;
+    }
+
+    std::string piece = token.substr(offset);
+    const double time = have_times ? timestamps[i] : 0.0;
+
+    if (piece.empty()) {
+      // A bare marker: the next token starts a new word
+      force_break = force_break || boundary;
+      continue;
+    }
+
+    const bool cjk = is_cjk(first_code_point(piece));
+
+    if (!open || boundary || force_break || cjk) {
+      close_word(time, true);
+      open = true;
+      word_start = time;
+    }
+
+    word += piece;
+    last_token_time = time;
+    last_token_end = time + (have_durations ? durations[i] : 0.0);
+    force_break = cjk;
+  }
+
+  close_word(0.0, false);
+
+  return out;
+}
+
+void append_words(writable::list &out, const WordSpans &spans) {
+  writable::strings words_vec(static_cast<R_xlen_t>(spans.words.size()));
+  for (size_t i = 0; i < spans.words.size(); ++i) {
+    words_vec[i] = spans.words[i];
+  }
+  out.push_back({"words"_nm = words_vec});
+
+  if (spans.starts.empty() && !spans.words.empty()) {
+    out.push_back({"word_starts"_nm = R_NilValue});
+    out.push_back({"word_ends"_nm = R_NilValue});
+    out.push_back({"word_durations"_nm = R_NilValue});
+    return;
+  }
+
+  out.push_back({"word_starts"_nm = writable::doubles(spans.starts.begin(), spans.starts.end())});
+  out.push_back({"word_ends"_nm = writable::doubles(spans.ends.begin(), spans.ends.end())});
+  // Durations only when the model reported token durations
+  if (spans.durations.empty() && !spans.words.empty()) {
+    out.push_back({"word_durations"_nm = R_NilValue});
+  } else {
+    out.push_back({"word_durations"_nm =
+                       writable::doubles(spans.durations.begin(), spans.durations.end())});
+  }
+}
+
+// Merge tokens of an existing result into words
+// timestamps and durations may be NULL
+[[cpp11::register]]
+list aggregate_words_(strings tokens, SEXP timestamps, SEXP durations) {
+  std::vector<std::string> token_vec(tokens.size());
+  for (R_xlen_t i = 0; i < tokens.size(); ++i) {
+    token_vec[i] = std::string(tokens[i]);
+  }
+
+  std::vector<double> timestamp_vec;
+  if (timestamps != R_NilValue) {
+    doubles ts(timestamps);
+    timestamp_vec.assign(ts.begin(), ts.end());
+  }
+
+  std::vector<double> duration_vec;
+  if (durations != R_NilValue) {
+    doubles ds(durations);
+    duration_vec.assign(ds.begin(), ds.end());
+  }
+
+  if (!timestamp_vec.empty() && timestamp_vec.size() != token_vec.size()) {
+    stop("timestamps must have one entry per token");
+  }
+
+  writable::list out;
+  append_words(out, aggregate_words(token_vec, timestamp_vec, duration_vec));
+  return out;
+}
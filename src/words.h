@@ -0,0 +1,41 @@
+// Word-level aggregation of subword tokens
+
+#ifndef SHERPA_ONNX_R_WORDS_H_
+#define SHERPA_ONNX_R_WORDS_H_
+
+#include <cpp11.hpp>
+#include <string>
+#include <vector>
+
+// Words assembled from tokens, as parallel vectors
+// starts/ends/durations are empty when the tokens have no timestamps, and
+// durations also when they have no durations: a word then ends where the
+// next one starts, and the last one a median token spacing after its last
+// token
+struct WordSpans {
+  std::vector<std::string> words;
+  std::vector<double> starts;
+  std::vector<double> ends;
+  std::vector<double> durations;
+};
+
+// Merge subword tokens into words using the model's word-boundary marker
+// (SentencePiece U+2581 prefix or Whisper-style leading space). CJK
+// characters form one word each and special tokens like <|en|> are dropped.
+// `timestamps` and `durations` may be empty; if given they must have one
+// entry per token.
+WordSpans aggregate_words(const std::vector<std::string> &tokens,
+                          const std::vector<double> &timestamps,
+                          const std::vector<double> &durations);
+
+// True if the text starts with a character of a script written without
+// spaces between words (CJK ideographs and kana)
+bool starts_with_cjk(const std::string &text);
+
+// Number of UTF-8 code points in a string
+size_t utf8_length(const std::string &text);
+
+// Append words, word_starts, word_ends and word_durations to a result list
+void append_words(cpp11::writable::list &out, const WordSpans &spans);
+
+#endif  // SHERPA_ONNX_R_WORDS_H_